@@ -0,0 +1,69 @@
+#ifndef _CLI_THREADS_H_
+#define _CLI_THREADS_H_
+
+#include <stdbool.h>
+
+/* Minimal thread/mutex/condition wrappers for the CLI tools (background writer, decode-ahead). */
+
+/* wasm builds don't have threads unless explicitly compiled with them */
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    #define CLI_THREADS_DISABLED
+#endif
+
+#ifndef CLI_THREADS_DISABLED
+
+#ifdef WIN32
+#include <windows.h>
+
+typedef HANDLE              cli_thread_t;
+typedef CRITICAL_SECTION    cli_mutex_t;
+typedef CONDITION_VARIABLE  cli_cond_t;
+#define CLI_THREAD_FUNC     DWORD WINAPI
+#define CLI_THREAD_RETURN   0
+
+static inline bool cli_thread_start(cli_thread_t* thread, LPTHREAD_START_ROUTINE func, void* arg) {
+    *thread = CreateThread(NULL, 0, func, arg, 0, NULL);
+    return *thread != NULL;
+}
+static inline void cli_thread_join(cli_thread_t* thread) {
+    WaitForSingleObject(*thread, INFINITE);
+    CloseHandle(*thread);
+}
+static inline void cli_mutex_init(cli_mutex_t* mutex)   { InitializeCriticalSection(mutex); }
+static inline void cli_mutex_free(cli_mutex_t* mutex)   { DeleteCriticalSection(mutex); }
+static inline void cli_mutex_lock(cli_mutex_t* mutex)   { EnterCriticalSection(mutex); }
+static inline void cli_mutex_unlock(cli_mutex_t* mutex) { LeaveCriticalSection(mutex); }
+static inline void cli_cond_init(cli_cond_t* cond)      { InitializeConditionVariable(cond); }
+static inline void cli_cond_free(cli_cond_t* cond)      { /* nothing */ }
+static inline void cli_cond_wait(cli_cond_t* cond, cli_mutex_t* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+static inline void cli_cond_signal(cli_cond_t* cond)    { WakeConditionVariable(cond); }
+
+#else
+#include <pthread.h>
+
+typedef pthread_t           cli_thread_t;
+typedef pthread_mutex_t     cli_mutex_t;
+typedef pthread_cond_t      cli_cond_t;
+#define CLI_THREAD_FUNC     void*
+#define CLI_THREAD_RETURN   NULL
+
+static inline bool cli_thread_start(cli_thread_t* thread, void* (*func)(void*), void* arg) {
+    return pthread_create(thread, NULL, func, arg) == 0;
+}
+static inline void cli_thread_join(cli_thread_t* thread) {
+    pthread_join(*thread, NULL);
+}
+static inline void cli_mutex_init(cli_mutex_t* mutex)   { pthread_mutex_init(mutex, NULL); }
+static inline void cli_mutex_free(cli_mutex_t* mutex)   { pthread_mutex_destroy(mutex); }
+static inline void cli_mutex_lock(cli_mutex_t* mutex)   { pthread_mutex_lock(mutex); }
+static inline void cli_mutex_unlock(cli_mutex_t* mutex) { pthread_mutex_unlock(mutex); }
+static inline void cli_cond_init(cli_cond_t* cond)      { pthread_cond_init(cond, NULL); }
+static inline void cli_cond_free(cli_cond_t* cond)      { pthread_cond_destroy(cond); }
+static inline void cli_cond_wait(cli_cond_t* cond, cli_mutex_t* mutex) { pthread_cond_wait(cond, mutex); }
+static inline void cli_cond_signal(cli_cond_t* cond)    { pthread_cond_signal(cond); }
+
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "decode_ring.h"
+#include "wav_utils.h"
+#include "cli_threads.h"
+
+
+typedef struct {
+    uint8_t* data;
+    int bytes;
+    int samples;
+} dr_slot_t;
+
+struct decode_ring_t {
+    libvgmstream_t* lib;
+    int buf_samples;
+
+    /* ring of slots: [head .. head + queued) belong to the player, the rest to the decoder */
+    uint8_t* data;
+    dr_slot_t* slots;
+    int depth;
+    int head;
+    int queued;
+
+    bool done;
+    int error;
+
+    bool threaded;
+#ifndef CLI_THREADS_DISABLED
+    bool closing;
+
+    cli_thread_t thread;
+    cli_mutex_t mutex;
+    cli_cond_t cond_queued; /* decoder > player: new slot available */
+    cli_cond_t cond_played; /* player > decoder: slot freed */
+#endif
+};
+
+
+static int fill_slot(decode_ring_t* dr, dr_slot_t* slot) {
+    libvgmstream_t* lib = dr->lib;
+
+    int err = libvgmstream_fill(lib, slot->data, dr->buf_samples);
+    if (err < 0) return err;
+
+    slot->bytes = lib->decoder->buf_bytes;
+    slot->samples = lib->decoder->buf_samples;
+
+    wav_swap_samples_le(slot->data, lib->format->channels * slot->samples, lib->format->sample_size);
+    return 0;
+}
+
+#ifndef CLI_THREADS_DISABLED
+
+static CLI_THREAD_FUNC decode_ring_thread(void* arg) {
+    decode_ring_t* dr = arg;
+
+    while (true) {
+        cli_mutex_lock(&dr->mutex);
+        while (dr->queued == dr->depth && !dr->closing) {
+            cli_cond_wait(&dr->cond_played, &dr->mutex);
+        }
+        if (dr->closing) {
+            cli_mutex_unlock(&dr->mutex);
+            break;
+        }
+        dr_slot_t* slot = &dr->slots[(dr->head + dr->queued) % dr->depth];
+        cli_mutex_unlock(&dr->mutex);
+
+        /* free slots (and lib) are only touched by this thread */
+        int err = fill_slot(dr, slot);
+        bool done = err < 0 || dr->lib->decoder->done;
+
+        cli_mutex_lock(&dr->mutex);
+        if (err < 0)
+            dr->error = err;
+        else
+            dr->queued++;
+        dr->done = done;
+        cli_cond_signal(&dr->cond_queued);
+        cli_mutex_unlock(&dr->mutex);
+
+        if (done)
+            break;
+    }
+
+    return CLI_THREAD_RETURN;
+}
+
+static bool start_thread(decode_ring_t* dr) {
+    cli_mutex_init(&dr->mutex);
+    cli_cond_init(&dr->cond_queued);
+    cli_cond_init(&dr->cond_played);
+
+    if (!cli_thread_start(&dr->thread, decode_ring_thread, dr)) {
+        cli_cond_free(&dr->cond_played);
+        cli_cond_free(&dr->cond_queued);
+        cli_mutex_free(&dr->mutex);
+        return false;
+    }
+
+    return true;
+}
+
+#endif
+
+
+decode_ring_t* decode_ring_open(libvgmstream_t* lib, int buf_samples, int ring_bytes) {
+    if (!lib || buf_samples <= 0)
+        return NULL;
+
+    /* mixing may change channels, use the biggest */
+    int channels = lib->format->channels;
+    if (channels < lib->format->input_channels)
+        channels = lib->format->input_channels;
+    int slot_bytes = buf_samples * channels * lib->format->sample_size;
+
+    int depth = ring_bytes / slot_bytes;
+    if (depth < 2)
+        depth = 1;
+
+    decode_ring_t* dr = calloc(1, sizeof(decode_ring_t));
+    if (!dr) return NULL;
+
+    dr->lib = lib;
+    dr->buf_samples = buf_samples;
+
+    dr->data = malloc(depth * slot_bytes);
+    dr->slots = calloc(depth, sizeof(dr_slot_t));
+    if (!dr->data || !dr->slots)
+        goto fail;
+
+    /* slots are only used in order so a single buffer is enough */
+    for (int i = 0; i < depth; i++) {
+        dr->slots[i].data = dr->data + i * slot_bytes;
+    }
+
+#ifndef CLI_THREADS_DISABLED
+    /* set before starting as the thread reads them right away */
+    dr->depth = depth;
+    dr->threaded = true;
+    if (depth > 1 && start_thread(dr))
+        return dr;
+#endif
+
+    /* decode on demand */
+    dr->depth = 1;
+    dr->threaded = false;
+    return dr;
+fail:
+    decode_ring_close(dr);
+    return NULL;
+}
+
+int decode_ring_get(decode_ring_t* dr, void** p_buf, int* p_samples) {
+    if (!dr)
+        return -1;
+
+    dr_slot_t* slot;
+#ifndef CLI_THREADS_DISABLED
+    if (dr->threaded) {
+        cli_mutex_lock(&dr->mutex);
+        while (dr->queued == 0 && !dr->done) {
+            cli_cond_wait(&dr->cond_queued, &dr->mutex);
+        }
+        if (dr->queued == 0) { /* done and nothing left */
+            int err = dr->error;
+            cli_mutex_unlock(&dr->mutex);
+            return err;
+        }
+        slot = &dr->slots[dr->head];
+        cli_mutex_unlock(&dr->mutex);
+    }
+    else
+#endif
+    {
+        if (dr->done)
+            return 0;
+
+        slot = &dr->slots[0];
+        int err = fill_slot(dr, slot);
+        if (err < 0) {
+            dr->done = true;
+            return err;
+        }
+        dr->done = dr->lib->decoder->done;
+    }
+
+    *p_buf = slot->data;
+    *p_samples = slot->samples;
+    return slot->bytes;
+}
+
+void decode_ring_release(decode_ring_t* dr) {
+    if (!dr)
+        return;
+
+#ifndef CLI_THREADS_DISABLED
+    if (dr->threaded) {
+        cli_mutex_lock(&dr->mutex);
+        dr->head = (dr->head + 1) % dr->depth;
+        dr->queued--;
+        cli_cond_signal(&dr->cond_played);
+        cli_mutex_unlock(&dr->mutex);
+    }
+#endif
+}
+
+void decode_ring_close(decode_ring_t* dr) {
+    if (!dr)
+        return;
+
+#ifndef CLI_THREADS_DISABLED
+    if (dr->threaded) {
+        cli_mutex_lock(&dr->mutex);
+        dr->closing = true;
+        cli_cond_signal(&dr->cond_played);
+        cli_mutex_unlock(&dr->mutex);
+
+        cli_thread_join(&dr->thread);
+
+        cli_cond_free(&dr->cond_played);
+        cli_cond_free(&dr->cond_queued);
+        cli_mutex_free(&dr->mutex);
+    }
+#endif
+
+    free(dr->slots);
+    free(dr->data);
+    free(dr);
+}
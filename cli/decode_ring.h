@@ -0,0 +1,28 @@
+#ifndef _DECODE_RING_H_
+#define _DECODE_RING_H_
+
+#include <stdbool.h>
+#include "../src/libvgmstream.h"
+
+/* A background thread decodes into a ring of PCM buffers ahead of playback, so slow
+ * decodes (FFmpeg, seeking, opening banks, etc) don't starve the audio device.
+ * Buffers are byte-swapped to LE (same as wav_swap_samples_le) before being handed out. */
+typedef struct decode_ring_t decode_ring_t;
+
+/* Starts decoding 'lib' with buffers of 'buf_samples' each, using up to 'ring_bytes' total.
+ * If the ring can't hold 2+ buffers or threads aren't available, decodes on demand instead
+ * (same as calling libvgmstream_fill serially). 'lib' must not be used by the caller until closed. */
+decode_ring_t* decode_ring_open(libvgmstream_t* lib, int buf_samples, int ring_bytes);
+
+/* Gets the next decoded buffer (waits if the decoder hasn't caught up).
+ * Returns buffer bytes, 0 when decoding is done, or < 0 on decode errors.
+ * Buffer is valid until decode_ring_release. */
+int decode_ring_get(decode_ring_t* dr, void** p_buf, int* p_samples);
+
+/* Returns the buffer from decode_ring_get to the decoder. */
+void decode_ring_release(decode_ring_t* dr);
+
+/* Stops the decoder thread (discarding pending buffers) and frees the ring. */
+void decode_ring_close(decode_ring_t* dr);
+
+#endif
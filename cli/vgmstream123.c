@@ -41,6 +41,8 @@
 
 
 #include "wav_utils.h"
+#include "decode_ring.h"
+#include "cli_threads.h"
 #include "../src/libvgmstream.h"
 
 
@@ -69,7 +71,7 @@
  */
 #define DOUBLE_INTERRUPT_TIME 1.0
 
-#define LITTLE_ENDIAN_OUTPUT 1 /* untested in BE */
+#define LITTLE_ENDIAN_OUTPUT 1 /* untested in BE (decode_ring outputs LE) */
 
 
 #define DEFAULT_CONFIG { 0, 0, 0, -1, 2.0, 10.0, 0.0,   0, 0, 0, 0,  0, 0 }
@@ -99,10 +101,11 @@ static ao_device *device = NULL;
 static ao_option *device_options = NULL;
 static ao_sample_format current_sample_format;
 
-static void* buffer = NULL;
 /* reportedly 1kb helps Raspberry Pi Zero play FFmpeg formats without stuttering
  * (presumably other low powered devices too), plus it's the default in other plugins */
 static int buffer_size_kb = 1;
+/* decoded audio kept ahead of playback, to absorb slow decodes */
+static int ring_size_kb = 256;
 
 static int repeat = 0;
 static int verbose = 0;
@@ -111,6 +114,7 @@ static volatile int interrupted = 0;
 static double interrupt_time = 0.0;
 
 static int play_file(const char* filename, song_config_t* cfg);
+static bool is_standard_file(const char* filename);
 
 static void interrupt_handler(int signum) {
     interrupted = 1;
@@ -247,53 +251,198 @@ static int getkey() {
 #endif
 
 
-static libvgmstream_t* open_vgmstream(const char* filename, song_config_t* cfg) {
-
+static libstreamfile_t* open_streamfile(const char* filename) {
     libstreamfile_t* sf = libstreamfile_open_from_stdio(filename);
     if (!sf) {
         fprintf(stderr, "%s: cannot open file\n", filename);
         return NULL;
     }
+    return sf;
+}
 
+/* sf may be reused to open other subsongs of the same file (errors are reported by caller) */
+static libvgmstream_t* open_vgmstream(libstreamfile_t* sf, song_config_t* cfg) {
     libvgmstream_config_t vcfg = {0};
 
     libvgmstream_t* vgmstream = libvgmstream_init();
+    if (!vgmstream)
+        return NULL;
+
     int err = libvgmstream_open_stream(vgmstream, sf, cfg->subsong_current_index);
-    if (err < 0) {
-        fprintf(stderr, "%s: error opening stream\n", filename);
+    if (err < 0)
         goto fail;
-    }
 
     // after opening since we need to know loops for some configs
     load_vconfig(&vcfg, cfg, vgmstream);
     libvgmstream_setup(vgmstream, &vcfg);
 
-    libstreamfile_close(sf);
     return vgmstream;
 fail:
-    libstreamfile_close(sf);
     libvgmstream_free(vgmstream);
     return NULL;
 }
 
+/* starts decoding ahead of playback (in another thread if possible) */
+static decode_ring_t* open_ring(libvgmstream_t* vgmstream) {
 
-static int play_vgmstream(const char* filename, song_config_t* cfg) {
-    int ret = 0;
-    FILE* save_fps[4];
-    size_t buffer_size;
-    int32_t max_buffer_samples;
+    /* Buffer size in bytes (after getting channels)
+     */
+    size_t buffer_size = 1024 * buffer_size_kb;
+    if (buffer_size_kb < 1) {
+        fprintf(stderr, "Invalid buffer size '%d'\n", buffer_size_kb);
+        return NULL;
+    }
 
+    int32_t max_buffer_samples = buffer_size / (vgmstream->format->input_channels * vgmstream->format->sample_size);
+    if (max_buffer_samples < 1)
+        max_buffer_samples = 1;
 
-    libvgmstream_t* vgmstream = open_vgmstream(filename, cfg);
-    if (!vgmstream)
-        return -1;
+    return decode_ring_open(vgmstream, max_buffer_samples, 1024 * ring_size_kb);
+}
 
-    /* force load total subsongs if signalled */
-    if (cfg->subsong_current_end == -1) {
-        cfg->subsong_current_end = vgmstream->format->subsong_count;
-        libvgmstream_free(vgmstream);
-        return 0;
+
+/* Next entry (subsong or playlist file) is opened and primed in another thread while
+ * the current one plays, so there is no gap waiting for the parser/decoder.
+ * The next entry always gets its own streamfile: stdio streamfiles dup() the same FILE
+ * (sharing the file offset), so they can't be read from two threads at once.
+ */
+typedef struct {
+    bool active;
+
+    /* key */
+    char filename[4096];
+    song_config_t cfg;
+
+    /* result */
+    libstreamfile_t* sf;
+    libvgmstream_t* vgmstream;
+    decode_ring_t* ring;
+
+    song_config_t cfg_open; /* may be modified when opening */
+#ifndef CLI_THREADS_DISABLED
+    bool threaded;
+    cli_thread_t thread;
+#endif
+} preopen_t;
+
+static preopen_t preopen;
+
+/* next playlist entry, opened once the current entry starts playing (if nothing else is preopened) */
+static const char* next_entry_filename = NULL;
+static song_config_t* next_entry_cfg = NULL;
+
+static void preopen_load(preopen_t* po) {
+    po->sf = libstreamfile_open_from_stdio(po->filename);
+    if (!po->sf) return;
+
+    /* errors are reported when actually played */
+    po->vgmstream = open_vgmstream(po->sf, &po->cfg_open);
+    if (!po->vgmstream)
+        return;
+
+    /* subsong range not resolved yet, let the player handle it */
+    if (po->cfg_open.subsong_current_end == -1)
+        return;
+
+    po->ring = open_ring(po->vgmstream);
+}
+
+#ifndef CLI_THREADS_DISABLED
+static CLI_THREAD_FUNC preopen_thread(void* arg) {
+    preopen_load(arg);
+    return CLI_THREAD_RETURN;
+}
+#endif
+
+static void preopen_wait(preopen_t* po) {
+#ifndef CLI_THREADS_DISABLED
+    if (po->threaded) {
+        cli_thread_join(&po->thread);
+        po->threaded = false;
     }
+#endif
+}
+
+static void preopen_cancel(void) {
+    preopen_t* po = &preopen;
+    if (!po->active)
+        return;
+
+    preopen_wait(po);
+    decode_ring_close(po->ring);
+    libvgmstream_free(po->vgmstream);
+    libstreamfile_close(po->sf);
+    memset(po, 0, sizeof(preopen_t));
+}
+
+static void preopen_start(const char* filename, song_config_t* cfg) {
+    preopen_t* po = &preopen;
+
+    preopen_cancel();
+    if (strlen(filename) >= sizeof(po->filename))
+        return;
+
+    po->active = true;
+    strcpy(po->filename, filename);
+    po->cfg = *cfg;
+    po->cfg_open = *cfg;
+
+#ifndef CLI_THREADS_DISABLED
+    po->threaded = cli_thread_start(&po->thread, preopen_thread, po);
+    if (po->threaded)
+        return;
+#endif
+    /* opened on demand when taken */
+    memset(po, 0, sizeof(preopen_t));
+}
+
+static bool same_config(song_config_t* a, song_config_t* b) {
+    return a->subsong_current_index == b->subsong_current_index &&
+        a->subsong_current_end == b->subsong_current_end &&
+        a->stereo_track == b->stereo_track &&
+        a->min_time == b->min_time &&
+        a->loop_count == b->loop_count &&
+        a->fade_time == b->fade_time &&
+        a->fade_delay == b->fade_delay &&
+        a->ignore_loop == b->ignore_loop &&
+        a->force_loop == b->force_loop &&
+        a->really_force_loop == b->really_force_loop &&
+        a->play_forever == b->play_forever;
+}
+
+/* Gets the preopened entry if it matches, otherwise discards it. */
+static bool preopen_take(const char* filename, song_config_t* cfg, libstreamfile_t** p_sf, libvgmstream_t** p_vgmstream, decode_ring_t** p_ring) {
+    preopen_t* po = &preopen;
+    if (!po->active)
+        return false;
+
+    if (strcmp(po->filename, filename) != 0 || !same_config(&po->cfg, cfg)) {
+        preopen_cancel();
+        return false;
+    }
+
+    preopen_wait(po);
+
+    /* retry normally to report errors */
+    if (!po->vgmstream) {
+        preopen_cancel();
+        return false;
+    }
+
+    *p_sf = po->sf;
+    *p_vgmstream = po->vgmstream;
+    *p_ring = po->ring;
+    *cfg = po->cfg_open;
+    memset(po, 0, sizeof(preopen_t));
+    return true;
+}
+
+
+/* plays and frees vgmstream and its ring (opened if not set) */
+static int play_vgmstream(const char* filename, song_config_t* cfg, libvgmstream_t* vgmstream, decode_ring_t* ring) {
+    int ret = 0;
+    FILE* save_fps[4] = {0};
+
 
     /* If the audio device hasn't been opened yet, then describe it
      */
@@ -338,22 +487,6 @@ static int play_vgmstream(const char* filename, song_config_t* cfg) {
     }
 
 
-    /* Buffer size in bytes (after getting channels)
-     */
-    buffer_size = 1024 * buffer_size_kb;
-    if (!buffer) {
-        if (buffer_size_kb < 1) {
-            fprintf(stderr, "Invalid buffer size '%d'\n", buffer_size_kb);
-            return -1;
-        }
-
-        buffer = malloc(buffer_size * vgmstream->format->sample_size);
-        if (!buffer) goto fail;
-    }
-
-    max_buffer_samples = buffer_size / (vgmstream->format->input_channels * vgmstream->format->sample_size);
-
-
     /* Init
      */
     ret = set_sample_format(vgmstream);
@@ -365,15 +498,29 @@ static int play_vgmstream(const char* filename, song_config_t* cfg) {
         goto fail;
     }
 
-    /* Decode
+    /* Decode (in another thread ahead of playback, if possible)
      */
+    if (!ring)
+        ring = open_ring(vgmstream);
+    if (!ring) {
+        ret = -1;
+        goto fail;
+    }
+
+    /* meanwhile get next playlist entry ready (unless current file has more subsongs) */
+    if (next_entry_filename && !preopen.active) {
+        preopen_start(next_entry_filename, next_entry_cfg);
+        next_entry_filename = NULL;
+    }
+
     {
         int64_t play_samples = vgmstream->format->play_samples;
+        int64_t play_position = 0;
         double time_total = (double)play_samples / vgmstream->format->sample_rate;
         int time_total_min = (int)time_total / 60;
         double time_total_sec = time_total - 60 * time_total_min;
 
-        while (!vgmstream->decoder->done && !interrupted) {
+        while (!interrupted) {
 #ifndef WIN32
             int key = getkey();
             if (key < 0) {
@@ -386,20 +533,15 @@ static int play_vgmstream(const char* filename, song_config_t* cfg) {
             }
 #endif
 
-            int err = libvgmstream_fill(vgmstream, buffer, max_buffer_samples);
-            if (err < 0) break;
+            void* buf = NULL;
+            int buf_samples = 0;
+            int buf_bytes = decode_ring_get(ring, &buf, &buf_samples);
+            if (buf_bytes <= 0) break;
 
-            void* buf = vgmstream->decoder->buf;
-            int buf_bytes = vgmstream->decoder->buf_bytes;
-            int buf_samples = vgmstream->decoder->buf_samples;
-            int sample_size = vgmstream->format->sample_size;
-    
-#if LITTLE_ENDIAN_OUTPUT
-            wav_swap_samples_le(buf, vgmstream->format->channels * buf_samples, sample_size);
-#endif
+            /* decoder runs ahead, so position is what has been sent to the device */
+            play_position += buf_samples;
 
             if (verbose && !out_filename) {
-                int64_t play_position = libvgmstream_get_play_position(vgmstream);
                 double played = (double)play_position / vgmstream->format->sample_rate;
                 double remain = (double)(play_samples - play_position) / vgmstream->format->sample_rate;
                 if (remain < 0)
@@ -426,6 +568,8 @@ static int play_vgmstream(const char* filename, song_config_t* cfg) {
                 ret = -1;
                 break;
             }
+
+            decode_ring_release(ring);
         }
 
 
@@ -452,6 +596,7 @@ static int play_vgmstream(const char* filename, song_config_t* cfg) {
 
 
 fail: //also decode done
+    decode_ring_close(ring);
     libvgmstream_free(vgmstream);
 
     for (int i = 0; i < 4; i++) {
@@ -463,22 +608,13 @@ fail: //also decode done
     return ret;
 }
 
-static int play_playlist(const char *filename, song_config_t* default_cfg) {
 #ifndef WIN32
-    int ret = 0;
-    FILE *f;
-    char *line = NULL;
-    size_t line_mem = 0;
+/* Reads next file entry, applying preceding metadata to cfg. Returns line length or < 0 at EOF. */
+static ssize_t read_playlist_entry(FILE* f, char** p_line, size_t* p_line_mem, song_config_t* cfg) {
     ssize_t line_len = 0;
-    song_config_t cfg = *default_cfg;
 
-    f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "%s: cannot open playlist file\n", filename);
-        return -1;
-    }
-
-    while ((line_len = getline(&line, &line_mem, f)) >= 0) {
+    while ((line_len = getline(p_line, p_line_mem, f)) >= 0) {
+        char* line = *p_line;
 
         /* Remove any leading whitespace
          */
@@ -508,13 +644,13 @@ static int play_playlist(const char *filename, song_config_t* default_cfg) {
                 if (arg) arg++;
 
                 if (PARAM_MATCHES("FADEDELAY"))
-                    cfg.fade_delay = atof(arg);
+                    cfg->fade_delay = atof(arg);
                 else if (PARAM_MATCHES("FADETIME"))
-                    cfg.fade_time = atof(arg);
+                    cfg->fade_time = atof(arg);
                 else if (PARAM_MATCHES("LOOPCOUNT"))
-                    cfg.loop_count = atof(arg);
+                    cfg->loop_count = atof(arg);
                 else if (PARAM_MATCHES("STREAMINDEX"))
-                    cfg.subsong_index = atoi(arg);
+                    cfg->subsong_index = atoi(arg);
 
                 param = strtok(NULL, ",");
             }
@@ -525,14 +661,60 @@ static int play_playlist(const char *filename, song_config_t* default_cfg) {
         if (line[0] == '\0' || line[0] == '#')
             continue;
 
+        return line_len;
+    }
+
+    return -1;
+}
+#endif
+
+static int play_playlist(const char *filename, song_config_t* default_cfg) {
+#ifndef WIN32
+    int ret = 0;
+    FILE *f;
+    char *line = NULL, *next_line = NULL;
+    size_t line_mem = 0, next_line_mem = 0;
+    song_config_t cfg = *default_cfg;
+
+    f = fopen(filename, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open playlist file\n", filename);
+        return -1;
+    }
+
+    /* next entry is read in advance, so it can be opened while current entry plays */
+    ssize_t line_len = read_playlist_entry(f, &line, &line_mem, &cfg);
+    while (line_len >= 0) {
+        song_config_t next_cfg = *default_cfg; /* reset playback options to default */
+        ssize_t next_line_len = read_playlist_entry(f, &next_line, &next_line_mem, &next_cfg);
+
+        song_config_t next_open_cfg = next_cfg;
+        next_entry_filename = NULL;
+        if (next_line_len >= 0 && is_standard_file(next_line)) {
+            /* same as play_standard */
+            next_open_cfg.subsong_current_index = next_open_cfg.subsong_index;
+            next_open_cfg.subsong_current_end = next_open_cfg.subsong_end;
+            next_entry_filename = next_line;
+            next_entry_cfg = &next_open_cfg;
+        }
+
         ret = play_file(line, &cfg);
+        next_entry_filename = NULL;
         if (ret) break;
 
-        /* Reset playback options to default */
-        memcpy(&cfg, default_cfg, sizeof(cfg));
+        char* tmp_line = line;
+        size_t tmp_line_mem = line_mem;
+        line = next_line;
+        line_mem = next_line_mem;
+        next_line = tmp_line;
+        next_line_mem = tmp_line_mem;
+
+        line_len = next_line_len;
+        cfg = next_cfg;
     }
 
     free(line);
+    free(next_line);
     fclose(f);
 
     return ret;
@@ -626,35 +808,86 @@ fail:
 #define ENDS_IN(EXT) !strcasecmp(EXT, filename + len - sizeof(EXT) + 1)
 
 static int play_standard(const char* filename, song_config_t* cfg) {
+    int ret = 0;
+    libstreamfile_t* sf = NULL;
+    libvgmstream_t* vgmstream = NULL;
+    decode_ring_t* ring = NULL;
+
+    // set base value for current file (passed files may have different number of subsongs)
+    cfg->subsong_current_index = cfg->subsong_index;
+    cfg->subsong_current_end = cfg->subsong_end;
+
+    // may be already opened while playing the previous entry
+    if (!preopen_take(filename, cfg, &sf, &vgmstream, &ring)) {
+        sf = open_streamfile(filename);
+        if (!sf)
+            return -1;
+        vgmstream = open_vgmstream(sf, cfg);
+    }
+    if (!vgmstream) {
+        fprintf(stderr, "%s: error opening stream\n", filename);
+        ret = -1;
+        goto done;
+    }
 
     /* standard */
     if (cfg->subsong_end == 0) {
-        cfg->subsong_current_index = cfg->subsong_index;
-
-        return play_vgmstream(filename, cfg);
+        ret = play_vgmstream(filename, cfg, vgmstream, ring);
+        goto done;
     }
 
     /* N subsongs */
 
-    // set base value for current file (passed files may have different number of subsongs)
-    cfg->subsong_current_index = cfg->subsong_index;
-    cfg->subsong_current_end = cfg->subsong_end;
-
-    // first call should force load max subsongs (if file has no subsongs this will be set to 1)
+    // first subsong tells max subsongs (if file has no subsongs this will be set to 1)
     if (cfg->subsong_current_end == -1) {
-        int ret = play_vgmstream(filename, cfg);
-        if (ret) return ret;
+        cfg->subsong_current_end = vgmstream->format->subsong_count;
+        if (cfg->subsong_current_end <= 0)
+            cfg->subsong_current_end = 1;
     }
 
-    // convert subsong range
-    while (cfg->subsong_current_index < cfg->subsong_current_end + 1) {
-        int ret = play_vgmstream(filename, cfg);
-        if (ret) return ret;
+    // convert subsong range, opening next subsong while current plays
+    while (true) {
+        if (cfg->subsong_current_index + 1 < cfg->subsong_current_end + 1) {
+            song_config_t next_cfg = *cfg;
+            next_cfg.subsong_current_index++;
+            preopen_start(filename, &next_cfg);
+        }
+
+        ret = play_vgmstream(filename, cfg, vgmstream, ring);
+        vgmstream = NULL;
+        ring = NULL;
+        if (ret) break;
 
         cfg->subsong_current_index++;
+        if (cfg->subsong_current_index >= cfg->subsong_current_end + 1)
+            break;
+
+        // preopened subsong comes with its own sf (current one isn't used anymore at this point)
+        libstreamfile_t* next_sf = NULL;
+        if (preopen_take(filename, cfg, &next_sf, &vgmstream, &ring)) {
+            libstreamfile_close(sf);
+            sf = next_sf;
+        }
+        else {
+            vgmstream = open_vgmstream(sf, cfg);
+        }
+        if (!vgmstream) {
+            fprintf(stderr, "%s: error opening stream\n", filename);
+            ret = -1;
+            break;
+        }
     }
 
-    return 0;
+done:
+    libstreamfile_close(sf);
+    return ret;
+}
+
+/* not a playlist or compressed file */
+static bool is_standard_file(const char* filename) {
+    size_t len = strlen(filename);
+
+    return !(ENDS_IN(".m3u") || ENDS_IN(".m3u8") || ENDS_IN(".bz2") || ENDS_IN(".gz") || ENDS_IN(".lzma") || ENDS_IN(".xz"));
 }
 
 static int play_file(const char* filename, song_config_t* cfg) {
@@ -726,6 +959,7 @@ static void print_usage(const char* progname, bool is_help) {
         "    -P KEY:VAL  Pass parameter KEY with value VAL to the output driver\n"
         "                (see https://www.xiph.org/ao/doc/drivers.html)\n"
         "    -B N        Use an audio buffer of N kilobytes [%d]\n"
+        "    -R N        Decode up to N kilobytes ahead of playback [%d] (0: decode on demand)\n"
         "    -@ LSTFILE  Read playlist from LSTFILE\n"
         "\n"
         #ifndef WIN32   //libao uses fopen(..., "w") instead of "wb" so any 0x0a (\n) becomes 0x0d0a (\r\n)...
@@ -752,6 +986,7 @@ static void print_usage(const char* progname, bool is_help) {
         "playlist referring to same. This program supports the \"EXT-X-VGMSTREAM\" tag\n"
         "in playlists, and files compressed with gzip/bzip2/xz.\n",
         buffer_size_kb,
+        ring_size_kb,
         default_cfg.loop_count,
         default_cfg.fade_time,
         default_cfg.fade_delay
@@ -787,7 +1022,7 @@ again_opts:
         cfg = default_cfg;
     }
 
-    while ((opt = getopt(argc, argv, "-D:f:l:M:s:2:B:d:o:P:@:hrmieEcS:")) != -1) {
+    while ((opt = getopt(argc, argv, "-D:f:l:M:s:2:B:R:d:o:P:@:hrmieEcS:")) != -1) {
         switch (opt) {
             case 1:
                 /* glibc getopt extension
@@ -845,8 +1080,10 @@ again_opts:
                 break;
 
             case 'B':
-                if (!buffer)
-                    buffer_size_kb = atoi(optarg);
+                buffer_size_kb = atoi(optarg);
+                break;
+            case 'R':
+                ring_size_kb = atoi(optarg);
                 break;
             case 'D':
                 driver_id = ao_driver_id(optarg);
@@ -900,10 +1137,9 @@ again_files:
     }
 
 done:
+    preopen_cancel();
     if (device)
         ao_close(device);
-    if (buffer)
-        free(buffer);
 
     ao_free_options(device_options);
     ao_shutdown();
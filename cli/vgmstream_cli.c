@@ -21,6 +21,7 @@
 
 #include "vgmstream_cli.h"
 #include "wav_utils.h"
+#include "write_pipe.h"
 
 #include "../version.h"
 #ifndef VGMSTREAM_VERSION
@@ -81,7 +82,11 @@ static void print_usage(const char* progname, bool is_help) {
             "    -D <max channels>: downmix to <max channels> (for plugin downmix testing)\n"
             "    -B <samples> force a sample buffer size (for api testing)\n"
             "    -W <type>: force .wav output format (1=PCM16, 2=PCM24, 3=PCM32, 4=float)\n"
+            "       5..8 are planar versions of the above, only with -O\n"
             "    -O: decode but don't write to file (for performance testing)\n"
+            "    -q N: write in a background thread with N queued buffers (decodes while writing)\n"
+            "    -R N: resample output to N Hz\n"
+            "    -Q N: resampling quality (1=low, 2=medium, 3=high)\n"
     );
 
 }
@@ -99,7 +104,7 @@ static bool parse_config(cli_config_t* cfg, int argc, char** argv) {
     optind = 1; /* reset getopt's ugly globals (needed in wasm that may call same main() multiple times) */
 
     /* read config */
-    while ((opt = getopt(argc, argv, "o:l:f:d:ipPcmxeLEFrgb2:s:tTk:K:hOvD:S:B:VIwW:")) != -1) {
+    while ((opt = getopt(argc, argv, "o:l:f:d:ipPcmxeLEFrgb2:s:tTk:K:hOvD:S:B:VIwW:q:R:Q:")) != -1) {
         switch (opt) {
             case 'o':
                 cfg->outfilename = optarg;
@@ -208,6 +213,15 @@ static bool parse_config(cli_config_t* cfg, int argc, char** argv) {
             case 'W':
                 cfg->wav_force_output = atoi(optarg);
                 break;
+            case 'q':
+                cfg->write_pipe_depth = atoi(optarg);
+                break;
+            case 'R':
+                cfg->resample_rate = atoi(optarg);
+                break;
+            case 'Q':
+                cfg->resample_quality = atoi(optarg);
+                break;
             case '2':
                 cfg->stereo_track = atoi(optarg) + 1;
                 break;
@@ -273,6 +287,10 @@ static bool validate_config(cli_config_t* cfg) {
         fprintf(stderr, "use either -p or -o\n");
         goto fail;
     }
+    if (cfg->wav_force_output >= LIBVGMSTREAM_SFMT_PCM16P && !cfg->decode_only) {
+        fprintf(stderr, "planar -W types can't be written to .wav, use -O\n");
+        goto fail;
+    }
 
     /* other options have built-in priority defined */
 
@@ -316,10 +334,13 @@ static void load_vconfig(libvgmstream_config_t* vcfg, cli_config_t* cfg) {
     }
 
     vcfg->stereo_track = cfg->stereo_track;
+    vcfg->resample_rate = cfg->resample_rate;
+    vcfg->resample_quality = cfg->resample_quality;
 }
 
 static bool write_file(libvgmstream_t* vgmstream, cli_config_t* cfg) {
     FILE* outfile = NULL;
+    write_pipe_t* wpipe = NULL;
     void* buf = NULL;
 
     /* simulate seek */
@@ -387,6 +408,11 @@ static bool write_file(libvgmstream_t* vgmstream, cli_config_t* cfg) {
         fwrite(wav_buf, sizeof(uint8_t), bytes_done, outfile);
     }
 
+    /* writes in another thread while decoding next buf (if threads aren't available writes normally) */
+    if (outfile && cfg->write_pipe_depth > 0) {
+        wpipe = write_pipe_open(outfile, cfg->write_pipe_depth, vgmstream->format->sample_size);
+    }
+
     /* decode (normally or forever until program kill) */
     while (!vgmstream->decoder->done) {
         if (buf) {
@@ -403,12 +429,18 @@ static bool write_file(libvgmstream_t* vgmstream, cli_config_t* cfg) {
         int buf_samples = vgmstream->decoder->buf_samples;
         int sample_size = vgmstream->format->sample_size;
 
-        if (!cfg->decode_only) {
+        if (wpipe) {
+            bool ok = write_pipe_push(wpipe, buf, buf_bytes, vgmstream->format->channels * buf_samples);
+            if (!ok) break;
+        }
+        else if (!cfg->decode_only) {
             wav_swap_samples_le(buf, vgmstream->format->channels * buf_samples, sample_size);
             fwrite(buf, sizeof(uint8_t), buf_bytes, outfile);
         }
     }
 
+    if (wpipe && !write_pipe_close(wpipe))
+        fprintf(stderr, "failed writing output\n");
     if (outfile && outfile != stdout)
         fclose(outfile);
     free(buf);
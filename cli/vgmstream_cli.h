@@ -37,6 +37,7 @@ typedef struct {
     bool write_lwav;
     bool write_original_wav;
     int wav_force_output;
+    int write_pipe_depth;
 
     // print flags
     bool print_metaonly;
@@ -55,6 +56,8 @@ typedef struct {
     int seek_samples2;
     int downmix_channels;
     int stereo_track;
+    int resample_rate;
+    int resample_quality;
 
 
     /* not quite config but eh */
@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "write_pipe.h"
+#include "wav_utils.h"
+#include "cli_threads.h"
+
+#ifndef CLI_THREADS_DISABLED
+
+typedef struct {
+    uint8_t* data;
+    int capacity;
+    int bytes;
+    int samples_len;
+} wp_slot_t;
+
+struct write_pipe_t {
+    FILE* outfile;
+    int sample_size;
+
+    /* ring of slots: [head .. head + queued) belong to the writer, the rest to the decoder */
+    wp_slot_t* slots;
+    int depth;
+    int head;
+    int queued;
+
+    bool closing;
+    bool failed;
+
+    cli_thread_t thread;
+    cli_mutex_t mutex;
+    cli_cond_t cond_queued;  /* decoder > writer: new slot available */
+    cli_cond_t cond_written; /* writer > decoder: slot freed */
+};
+
+
+static CLI_THREAD_FUNC write_pipe_thread(void* arg) {
+    write_pipe_t* wp = arg;
+
+    while (true) {
+        cli_mutex_lock(&wp->mutex);
+        while (wp->queued == 0 && !wp->closing) {
+            cli_cond_wait(&wp->cond_queued, &wp->mutex);
+        }
+        if (wp->queued == 0) { /* closing and nothing left */
+            cli_mutex_unlock(&wp->mutex);
+            break;
+        }
+        wp_slot_t* slot = &wp->slots[wp->head];
+        cli_mutex_unlock(&wp->mutex);
+
+        /* slot is owned by this thread until released below (failed is only set by this thread) */
+        bool write_ok = true;
+        if (!wp->failed) {
+            wav_swap_samples_le(slot->data, slot->samples_len, wp->sample_size);
+            size_t bytes_done = fwrite(slot->data, sizeof(uint8_t), slot->bytes, wp->outfile);
+            write_ok = (bytes_done == slot->bytes);
+        }
+
+        cli_mutex_lock(&wp->mutex);
+        if (!write_ok)
+            wp->failed = true;
+        wp->head = (wp->head + 1) % wp->depth;
+        wp->queued--;
+        cli_cond_signal(&wp->cond_written);
+        cli_mutex_unlock(&wp->mutex);
+    }
+
+    return CLI_THREAD_RETURN;
+}
+
+
+write_pipe_t* write_pipe_open(FILE* outfile, int depth, int sample_size) {
+    if (!outfile)
+        return NULL;
+    if (depth < 2)
+        depth = 2;
+
+    write_pipe_t* wp = calloc(1, sizeof(write_pipe_t));
+    if (!wp) return NULL;
+
+    wp->outfile = outfile;
+    wp->sample_size = sample_size;
+    wp->depth = depth;
+
+    wp->slots = calloc(depth, sizeof(wp_slot_t));
+    if (!wp->slots) {
+        free(wp);
+        return NULL;
+    }
+
+    cli_mutex_init(&wp->mutex);
+    cli_cond_init(&wp->cond_queued);
+    cli_cond_init(&wp->cond_written);
+
+    if (!cli_thread_start(&wp->thread, write_pipe_thread, wp)) {
+        cli_cond_free(&wp->cond_written);
+        cli_cond_free(&wp->cond_queued);
+        cli_mutex_free(&wp->mutex);
+        free(wp->slots);
+        free(wp);
+        return NULL;
+    }
+
+    return wp;
+}
+
+bool write_pipe_push(write_pipe_t* wp, const void* buf, int buf_bytes, int samples_len) {
+    if (!wp)
+        return false;
+
+    cli_mutex_lock(&wp->mutex);
+    while (wp->queued == wp->depth) {
+        cli_cond_wait(&wp->cond_written, &wp->mutex);
+    }
+    int index = (wp->head + wp->queued) % wp->depth;
+    bool failed = wp->failed;
+    cli_mutex_unlock(&wp->mutex);
+
+    if (failed)
+        return false;
+
+    /* free slots aren't touched by the writer, no need to lock here */
+    wp_slot_t* slot = &wp->slots[index];
+    if (slot->capacity < buf_bytes) {
+        uint8_t* data = realloc(slot->data, buf_bytes);
+        if (!data) return false;
+        slot->data = data;
+        slot->capacity = buf_bytes;
+    }
+
+    memcpy(slot->data, buf, buf_bytes);
+    slot->bytes = buf_bytes;
+    slot->samples_len = samples_len;
+
+    cli_mutex_lock(&wp->mutex);
+    wp->queued++;
+    cli_cond_signal(&wp->cond_queued);
+    cli_mutex_unlock(&wp->mutex);
+
+    return true;
+}
+
+bool write_pipe_close(write_pipe_t* wp) {
+    if (!wp)
+        return false;
+
+    cli_mutex_lock(&wp->mutex);
+    wp->closing = true;
+    cli_cond_signal(&wp->cond_queued);
+    cli_mutex_unlock(&wp->mutex);
+
+    cli_thread_join(&wp->thread);
+
+    bool ok = !wp->failed;
+
+    cli_cond_free(&wp->cond_written);
+    cli_cond_free(&wp->cond_queued);
+    cli_mutex_free(&wp->mutex);
+    for (int i = 0; i < wp->depth; i++) {
+        free(wp->slots[i].data);
+    }
+    free(wp->slots);
+    free(wp);
+
+    return ok;
+}
+
+#else
+
+write_pipe_t* write_pipe_open(FILE* outfile, int depth, int sample_size) {
+    return NULL;
+}
+
+bool write_pipe_push(write_pipe_t* wp, const void* buf, int buf_bytes, int samples_len) {
+    return false;
+}
+
+bool write_pipe_close(write_pipe_t* wp) {
+    return false;
+}
+
+#endif
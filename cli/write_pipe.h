@@ -0,0 +1,24 @@
+#ifndef _WRITE_PIPE_H_
+#define _WRITE_PIPE_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* Decoded buffers are queued here and a background thread byte-swaps and writes them,
+ * so decoding can continue while fwrite blocks (slow disks, piping to encoders, etc).
+ * Output bytes are the same as calling wav_swap_samples_le + fwrite serially. */
+typedef struct write_pipe_t write_pipe_t;
+
+/* Starts the writer thread with 'depth' queued buffers (min 2).
+ * Returns NULL if threads aren't available or on error (caller should write serially). */
+write_pipe_t* write_pipe_open(FILE* outfile, int depth, int sample_size);
+
+/* Copies buf to the next free slot (waits if all slots are queued).
+ * Returns false if the writer thread failed (write errors). */
+bool write_pipe_push(write_pipe_t* wp, const void* buf, int buf_bytes, int samples_len);
+
+/* Waits until all queued buffers are written, then stops the thread and frees the pipe.
+ * Returns false if any write failed. */
+bool write_pipe_close(write_pipe_t* wp);
+
+#endif
@@ -51,7 +51,9 @@ LIBVGMSTREAM_API void libvgmstream_free(libvgmstream_t* lib) {
     libvgmstream_priv_t* priv = lib->priv;
     if (priv) {
         close_vgmstream(priv->vgmstream);
+        resampler_free(priv->resampler);
         free(priv->buf.data);
+        free(priv->buf.tmp);
     }
 
     free(priv);
@@ -101,25 +103,32 @@ void libvgmstream_priv_reset(libvgmstream_priv_t* priv, bool full) {
     
     if (full) {
         free(priv->buf.data); //TODO 
+        free(priv->buf.tmp);
         memset(&priv->buf, 0, sizeof(libvgmstream_priv_buf_t));
         memset(&priv->fmt, 0, sizeof(libvgmstream_format_t));
+
+        resampler_free(priv->resampler);
+        priv->resampler = NULL;
     }
     else {
         priv->buf.consumed = priv->buf.samples;
+        resampler_reset(priv->resampler, 0);
     }
 
     priv->pos.current = 0;
+    priv->pos.input_current = 0;
     priv->decode_done = false;
 }
 
 libvgmstream_sfmt_t api_get_output_sample_type(libvgmstream_priv_t* priv) {
     VGMSTREAM* v = priv->vgmstream;
     sfmt_t format = mixing_get_output_sample_type(v);
+    bool planar = api_is_planar_sample_type(priv->cfg.force_sfmt);
     switch(format) {
-        case SFMT_S16: return LIBVGMSTREAM_SFMT_PCM16;
-        case SFMT_FLT: return LIBVGMSTREAM_SFMT_FLOAT;
-        case SFMT_S32: return LIBVGMSTREAM_SFMT_PCM32;
-        case SFMT_O24: return LIBVGMSTREAM_SFMT_PCM24;
+        case SFMT_S16: return planar ? LIBVGMSTREAM_SFMT_PCM16P : LIBVGMSTREAM_SFMT_PCM16;
+        case SFMT_FLT: return planar ? LIBVGMSTREAM_SFMT_FLOATP : LIBVGMSTREAM_SFMT_FLOAT;
+        case SFMT_S32: return planar ? LIBVGMSTREAM_SFMT_PCM32P : LIBVGMSTREAM_SFMT_PCM32;
+        case SFMT_O24: return planar ? LIBVGMSTREAM_SFMT_PCM24P : LIBVGMSTREAM_SFMT_PCM24;
          
         // internal use only, shouldn't happen (misconfigured, see prepare_mixing)
         case SFMT_S24:
@@ -129,15 +138,53 @@ libvgmstream_sfmt_t api_get_output_sample_type(libvgmstream_priv_t* priv) {
     }
 }
 
+int api_get_render_samples(libvgmstream_priv_t* priv) {
+    int render_samples = priv->cfg.render_samples;
+    if (render_samples <= 0)
+        return INTERNAL_BUF_SAMPLES;
+    if (render_samples > INTERNAL_BUF_SAMPLES_MAX)
+        return INTERNAL_BUF_SAMPLES_MAX;
+    return render_samples;
+}
+
+// converts stream samples to output samples when resampling
+int64_t api_get_output_samples(libvgmstream_priv_t* priv, int64_t input_samples) {
+    if (!priv->resampler)
+        return input_samples;
+    return input_samples * priv->cfg.resample_rate / priv->vgmstream->sample_rate;
+}
+
+int64_t api_get_input_samples(libvgmstream_priv_t* priv, int64_t output_samples) {
+    if (!priv->resampler)
+        return output_samples;
+    return output_samples * priv->vgmstream->sample_rate / priv->cfg.resample_rate;
+}
+
 int api_get_sample_size(libvgmstream_sfmt_t sample_format) {
     switch(sample_format) {
         case LIBVGMSTREAM_SFMT_FLOAT:
         case LIBVGMSTREAM_SFMT_PCM32:
+        case LIBVGMSTREAM_SFMT_FLOATP:
+        case LIBVGMSTREAM_SFMT_PCM32P:
             return 0x04;
         case LIBVGMSTREAM_SFMT_PCM24:
+        case LIBVGMSTREAM_SFMT_PCM24P:
             return 0x03;
         case LIBVGMSTREAM_SFMT_PCM16:
+        case LIBVGMSTREAM_SFMT_PCM16P:
         default:
             return 0x02;
     }
 }
+
+bool api_is_planar_sample_type(libvgmstream_sfmt_t sample_format) {
+    switch(sample_format) {
+        case LIBVGMSTREAM_SFMT_PCM16P:
+        case LIBVGMSTREAM_SFMT_PCM24P:
+        case LIBVGMSTREAM_SFMT_PCM32P:
+        case LIBVGMSTREAM_SFMT_FLOATP:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -50,10 +50,14 @@ static void prepare_mixing(libvgmstream_priv_t* priv) {
         // external force
         sfmt_t force_sfmt = SFMT_NONE;
         switch(cfg->force_sfmt) {
-            case LIBVGMSTREAM_SFMT_PCM16: force_sfmt = SFMT_S16; break;
-            case LIBVGMSTREAM_SFMT_FLOAT: force_sfmt = SFMT_FLT; break;
-            case LIBVGMSTREAM_SFMT_PCM24: force_sfmt = SFMT_O24; break;
-            case LIBVGMSTREAM_SFMT_PCM32: force_sfmt = SFMT_S32; break;
+            case LIBVGMSTREAM_SFMT_PCM16:
+            case LIBVGMSTREAM_SFMT_PCM16P: force_sfmt = SFMT_S16; break;
+            case LIBVGMSTREAM_SFMT_FLOAT:
+            case LIBVGMSTREAM_SFMT_FLOATP: force_sfmt = SFMT_FLT; break;
+            case LIBVGMSTREAM_SFMT_PCM24:
+            case LIBVGMSTREAM_SFMT_PCM24P: force_sfmt = SFMT_O24; break;
+            case LIBVGMSTREAM_SFMT_PCM32:
+            case LIBVGMSTREAM_SFMT_PCM32P: force_sfmt = SFMT_S32; break;
             default: break;
         }
 
@@ -72,7 +76,24 @@ static void prepare_mixing(libvgmstream_priv_t* priv) {
         mixing_macro_output_sample_format(priv->vgmstream, force_sfmt);
     }
 
-    vgmstream_mixing_enable(priv->vgmstream, INTERNAL_BUF_SAMPLES, NULL /*&input_channels*/, NULL /*&output_channels*/);
+    vgmstream_mixing_enable(priv->vgmstream, api_get_render_samples(priv), NULL /*&input_channels*/, NULL /*&output_channels*/);
+}
+
+static void prepare_resampler(libvgmstream_priv_t* priv) {
+    libvgmstream_config_t* cfg = &priv->cfg;
+    VGMSTREAM* v = priv->vgmstream;
+
+    if (cfg->resample_rate <= 0 || cfg->resample_rate == v->sample_rate || v->sample_rate <= 0)
+        return;
+
+    // after mixing (output channels)
+    int output_channels = 0;
+    vgmstream_mixing_enable(v, 0, NULL, &output_channels); //query
+
+    priv->resampler = resampler_init(output_channels, v->sample_rate, cfg->resample_rate, cfg->resample_quality, api_get_render_samples(priv));
+    if (!priv->resampler) {
+        VGM_LOG("API: can't init resampler\n");
+    }
 }
 
 static void update_position(libvgmstream_priv_t* priv) {
@@ -80,8 +101,10 @@ static void update_position(libvgmstream_priv_t* priv) {
     VGMSTREAM* v = priv->vgmstream;
 
     pos->play_forever = vgmstream_get_play_forever(v);
-    pos->play_samples = vgmstream_get_samples(v);
+    pos->input_play_samples = vgmstream_get_samples(v);
+    pos->play_samples = api_get_output_samples(priv, pos->input_play_samples);
     pos->current = 0;
+    pos->input_current = 0;
 }
 
 static void update_format_info(libvgmstream_priv_t* priv) {
@@ -99,11 +122,12 @@ static void update_format_info(libvgmstream_priv_t* priv) {
     fmt->sample_format = api_get_output_sample_type(priv);
     fmt->sample_size = api_get_sample_size(fmt->sample_format);
 
-    fmt->sample_rate = v->sample_rate;
+    fmt->sample_rate = priv->resampler ? priv->cfg.resample_rate : v->sample_rate;
+    fmt->input_sample_rate = v->sample_rate;
 
-    fmt->stream_samples = v->num_samples;
-    fmt->loop_start = v->loop_start_sample;
-    fmt->loop_end = v->loop_end_sample;
+    fmt->stream_samples = api_get_output_samples(priv, v->num_samples);
+    fmt->loop_start = api_get_output_samples(priv, v->loop_start_sample);
+    fmt->loop_end = api_get_output_samples(priv, v->loop_end_sample);
     fmt->loop_flag = v->loop_flag;
 
     fmt->play_forever = priv->pos.play_forever;
@@ -131,6 +155,7 @@ void api_apply_config(libvgmstream_priv_t* priv) {
 
     apply_config(priv);
     prepare_mixing(priv);
+    prepare_resampler(priv);
 
     update_position(priv);
     update_format_info(priv);
@@ -146,6 +171,7 @@ static void load_vgmstream(libvgmstream_priv_t* priv, libstreamfile_t* libsf, in
     //TODO: handle format_id
 
     sf_api->stream_index = subsong_index;
+    sf_api->io_buffer_size = priv->cfg.io_buffer_size;
     priv->vgmstream = init_vgmstream_from_STREAMFILE(sf_api);
     close_streamfile(sf_api);
 }
@@ -4,12 +4,7 @@
 #include "../util/log.h"
 
 
-static bool reset_buf(libvgmstream_priv_t* priv) {
-    // state reset
-    priv->buf.samples = 0;
-    priv->buf.bytes = 0;
-    priv->buf.consumed = 0;
-
+static bool init_buf(libvgmstream_priv_t* priv) {
     if (priv->buf.initialized)
         return true;
 
@@ -30,28 +25,194 @@ static bool reset_buf(libvgmstream_priv_t* priv) {
     if (max_sample_size < output_sample_size)
         max_sample_size = output_sample_size;
 
-    priv->buf.max_samples = INTERNAL_BUF_SAMPLES;
+    priv->buf.max_samples = api_get_render_samples(priv);
     priv->buf.sample_size = output_sample_size;
     priv->buf.channels = output_channels;
+    priv->buf.frame_size = max_sample_size * max_channels;
+    priv->buf.planar = api_is_planar_sample_type(priv->cfg.force_sfmt);
+    priv->buf.planar_render = priv->buf.planar && render_supports_planar(priv->vgmstream);
 
-    int max_bytes = priv->buf.max_samples * max_sample_size * max_channels;
+    int max_bytes = priv->buf.max_samples * priv->buf.frame_size;
     priv->buf.data = malloc(max_bytes);
     if (!priv->buf.data) return false;
 
+    if (priv->resampler || (priv->buf.planar && !priv->buf.planar_render)) {
+        priv->buf.tmp = malloc(max_bytes);
+        if (!priv->buf.tmp) return false;
+    }
+
     priv->buf.initialized = true;
     return true;
 }
 
+static bool reset_buf(libvgmstream_priv_t* priv) {
+    // state reset
+    priv->buf.samples = 0;
+    priv->buf.bytes = 0;
+    priv->buf.consumed = 0;
+
+    return init_buf(priv);
+}
+
+static void update_position(libvgmstream_priv_t* priv, int samples_done) {
+    priv->pos.current += samples_done;
+
+    // mark done if this buf reached EOF
+    if (!priv->pos.play_forever) {
+        priv->decode_done = (priv->pos.current >= priv->pos.play_samples);
+    }
+}
+
 static void update_buf(libvgmstream_priv_t* priv, int samples_done) {
     priv->buf.samples = samples_done;
     priv->buf.bytes = samples_done * priv->buf.sample_size * priv->buf.channels;
     //priv->buf.consumed = 0; //external
 
-    // mark done if this buf reached EOF
-    if (!priv->pos.play_forever) {
-        priv->pos.current += samples_done;
-        priv->decode_done = (priv->pos.current >= priv->pos.play_samples);
+    update_position(priv, samples_done);
+}
+
+// samples that the next render may return (limited by internal buf size and play length)
+static int get_render_samples(libvgmstream_priv_t* priv) {
+    int to_get = priv->buf.max_samples;
+    if (!priv->pos.play_forever && to_get + priv->pos.current > priv->pos.play_samples)
+        to_get = priv->pos.play_samples - priv->pos.current;
+    return to_get;
+}
+
+// decodes into any buf as big as to_get * frame_size (input may need more space than output before mixing)
+static int render_buf(libvgmstream_priv_t* priv, void* buf, int to_get) {
+    sbuf_t ssrc;
+    sfmt_t sfmt = mixing_get_input_sample_type(priv->vgmstream);
+    sbuf_init(&ssrc, sfmt, buf, to_get, priv->vgmstream->channels);
+
+    return render_main(&ssrc, priv->vgmstream);
+}
+
+// decodes into planar buf where each channel is plane_size apart (buf is as big as plane_size * frame_size if
+// rendered directly, or plane_size * output channels/sample size otherwise)
+static int render_buf_planar(libvgmstream_priv_t* priv, void* buf, int to_get, int plane_size) {
+    sbuf_t sdst;
+    sfmt_t sfmt = mixing_get_input_sample_type(priv->vgmstream);
+
+    if (priv->buf.planar_render) {
+        sbuf_init_planar(&sdst, sfmt, buf, to_get, priv->vgmstream->channels, plane_size);
+        return render_main(&sdst, priv->vgmstream);
     }
+
+    // old-style decoders only write interleaved samples, so convert after render (mixing may change fmt/channels)
+    sbuf_t ssrc;
+    sbuf_init(&ssrc, sfmt, priv->buf.tmp, to_get, priv->vgmstream->channels);
+    int done = render_main(&ssrc, priv->vgmstream);
+
+    sbuf_init_planar(&sdst, ssrc.fmt, buf, to_get, ssrc.channels, plane_size);
+    sbuf_copy_segments(&sdst, &ssrc, done);
+    return done;
+}
+
+// decodes at stream's rate into tmp buf then resamples into buf (only needs output size)
+static int render_buf_resampled(libvgmstream_priv_t* priv, void* buf, int to_get, int plane_size) {
+    resampler_t* rs = priv->resampler;
+    libvgmstream_priv_position_t* pos = &priv->pos;
+    sfmt_t input_sfmt = mixing_get_input_sample_type(priv->vgmstream);
+    sfmt_t output_sfmt = mixing_get_output_sample_type(priv->vgmstream);
+
+    sbuf_t sdst;
+    if (plane_size)
+        sbuf_init_planar(&sdst, output_sfmt, buf, to_get, priv->buf.channels, plane_size);
+    else
+        sbuf_init(&sdst, output_sfmt, buf, to_get, priv->buf.channels);
+
+    // pull what's available then feed more input (in steps, as downsampling needs more input than buf size)
+    bool flushed = false;
+    while (true) {
+        resampler_pull(rs, &sdst, to_get - sdst.filled);
+        if (sdst.filled >= to_get || flushed)
+            break;
+
+        int input_get = resampler_get_input_samples(rs, to_get - sdst.filled);
+        if (input_get > priv->buf.max_samples)
+            input_get = priv->buf.max_samples;
+        if (!pos->play_forever && input_get > pos->input_play_samples - pos->input_current)
+            input_get = pos->input_play_samples - pos->input_current;
+
+        if (input_get <= 0) {
+            // stream is over, push silence to get the last samples
+            resampler_flush(rs);
+            flushed = true;
+            continue;
+        }
+
+        sbuf_t ssrc;
+        sbuf_init(&ssrc, input_sfmt, priv->buf.tmp, input_get, priv->vgmstream->channels);
+        int done = render_main(&ssrc, priv->vgmstream);
+        ssrc.filled = done;
+
+        resampler_push(rs, &ssrc);
+        pos->input_current += done;
+    }
+
+    // shouldn't happen as flushing gives enough samples for output's total
+    if (sdst.filled < to_get) {
+        sbuf_silence_rest(&sdst);
+    }
+    return to_get;
+}
+
+// moves planes in internal buf so each channel is right after the previous one
+static void pack_planes(libvgmstream_priv_t* priv, int done, int plane_size) {
+    if (done >= plane_size)
+        return;
+
+    uint8_t* buf = priv->buf.data;
+    int plane_bytes = priv->buf.sample_size * done;
+    for (int ch = 1; ch < priv->buf.channels; ch++) {
+        memmove(buf + ch * plane_bytes, buf + ch * priv->buf.sample_size * plane_size, plane_bytes);
+    }
+}
+
+// decodes into internal buf (planar bufs are packed, with each channel right after the previous one)
+static int render_buf_internal(libvgmstream_priv_t* priv, int to_get) {
+    int done;
+
+    if (priv->resampler) {
+        done = render_buf_resampled(priv, priv->buf.data, to_get, priv->buf.planar ? to_get : 0);
+    }
+    else if (priv->buf.planar) {
+        done = render_buf_planar(priv, priv->buf.data, to_get, to_get);
+    }
+    else {
+        return render_buf(priv, priv->buf.data, to_get);
+    }
+
+    if (priv->buf.planar) {
+        pack_planes(priv, done, to_get);
+    }
+    return done;
+}
+
+// whether a full render fits in the external buf, considering pre-mixing size
+static bool is_direct_render(libvgmstream_priv_t* priv, int buf_left, int to_get) {
+    if (to_get <= 0)
+        return false;
+
+    // resampling only writes output
+    if (priv->resampler)
+        return buf_left >= to_get;
+
+    int output_frame_size = priv->buf.sample_size * priv->buf.channels;
+    if (priv->buf.planar) {
+        // when converted from a tmp buf only output needs to fit, otherwise pre-mixing channels go in the same planes
+        // (and must use the same sample size, or output planes would overlap input planes of next renders)
+        if (priv->buf.planar_render) {
+            int input_sample_size = sfmt_get_sample_size(mixing_get_input_sample_type(priv->vgmstream));
+            if (priv->buf.frame_size > output_frame_size || input_sample_size != priv->buf.sample_size)
+                return false;
+        }
+        return buf_left >= to_get;
+    }
+
+    int64_t dst_bytes = (int64_t)buf_left * output_frame_size;
+    return dst_bytes >= (int64_t)to_get * priv->buf.frame_size;
 }
 
 
@@ -83,15 +244,8 @@ LIBVGMSTREAM_API int libvgmstream_render(libvgmstream_t* lib) {
     if (!reset_buf(priv))
         return LIBVGMSTREAM_ERROR_GENERIC;
 
-    int to_get = priv->buf.max_samples;
-    if (!priv->pos.play_forever && to_get + priv->pos.current > priv->pos.play_samples)
-        to_get = priv->pos.play_samples - priv->pos.current;
-
-    sbuf_t ssrc;
-    sfmt_t sfmt = mixing_get_input_sample_type(priv->vgmstream);
-    sbuf_init(&ssrc, sfmt, priv->buf.data, to_get, priv->vgmstream->channels);
-
-    int decoded = render_main(&ssrc, priv->vgmstream);
+    int to_get = get_render_samples(priv);
+    int decoded = render_buf_internal(priv, to_get);
     update_buf(priv, decoded);
     update_decoder_info(priv);
 
@@ -99,13 +253,21 @@ LIBVGMSTREAM_API int libvgmstream_render(libvgmstream_t* lib) {
 }
 
 
-/* _play decodes a single frame, while this copies partially that frame until frame is over */
+/* _play decodes a single frame, while this copies partially that frame until frame is over.
+ * If external buf has enough space for a whole frame it's decoded there directly (no copies). */
 LIBVGMSTREAM_API int libvgmstream_fill(libvgmstream_t* lib, void* buf, int buf_samples) {
     if (!lib || !lib->priv || !buf || !buf_samples)
         return LIBVGMSTREAM_ERROR_GENERIC;
 
     libvgmstream_priv_t* priv = lib->priv;
 
+    if (!priv->setup_done) {
+        api_apply_config(priv);
+    }
+
+    if (!init_buf(priv))
+        return LIBVGMSTREAM_ERROR_GENERIC;
+
     bool done = false;
     int buf_copied = 0;
     while (buf_copied < buf_samples) {
@@ -117,6 +279,30 @@ LIBVGMSTREAM_API int libvgmstream_fill(libvgmstream_t* lib, void* buf, int buf_s
                 break;
             }
 
+            // decode into external buf if a full frame fits
+            int buf_left = buf_samples - buf_copied;
+            int to_get = get_render_samples(priv);
+            if (is_direct_render(priv, buf_left, to_get)) {
+                int decoded;
+                if (priv->resampler) {
+                    int plane_size = priv->buf.planar ? buf_samples : 0;
+                    int copied_bytes = priv->buf.sample_size * buf_copied * (priv->buf.planar ? 1 : priv->buf.channels);
+                    decoded = render_buf_resampled(priv, ((uint8_t*)buf) + copied_bytes, to_get, plane_size);
+                }
+                else if (priv->buf.planar) {
+                    int copied_bytes = priv->buf.sample_size * buf_copied;
+                    decoded = render_buf_planar(priv, ((uint8_t*)buf) + copied_bytes, to_get, buf_samples);
+                }
+                else {
+                    int copied_bytes = priv->buf.sample_size * priv->buf.channels * buf_copied;
+                    decoded = render_buf(priv, ((uint8_t*)buf) + copied_bytes, to_get);
+                }
+                update_position(priv, decoded);
+
+                buf_copied += decoded;
+                continue;
+            }
+
             int err = libvgmstream_render(lib);
             if (err < 0) return err;
         }
@@ -127,11 +313,23 @@ LIBVGMSTREAM_API int libvgmstream_fill(libvgmstream_t* lib, void* buf, int buf_s
         if (copy_samples > buf_left)
             copy_samples = buf_left;
 
-        int copy_bytes = priv->buf.sample_size * priv->buf.channels * copy_samples;
-        int skip_bytes = priv->buf.sample_size * priv->buf.channels * priv->buf.consumed;
-        int copied_bytes = priv->buf.sample_size * priv->buf.channels * buf_copied;
+        if (priv->buf.planar) {
+            // src channels are buf.samples apart, dst channels buf_samples apart
+            int sample_size = priv->buf.sample_size;
+            for (int ch = 0; ch < priv->buf.channels; ch++) {
+                int skip_bytes = sample_size * (ch * priv->buf.samples + priv->buf.consumed);
+                int copied_bytes = sample_size * (ch * buf_samples + buf_copied);
 
-        memcpy( ((uint8_t*)buf) + copied_bytes, ((uint8_t*)priv->buf.data) + skip_bytes, copy_bytes);
+                memcpy( ((uint8_t*)buf) + copied_bytes, ((uint8_t*)priv->buf.data) + skip_bytes, sample_size * copy_samples);
+            }
+        }
+        else {
+            int copy_bytes = priv->buf.sample_size * priv->buf.channels * copy_samples;
+            int skip_bytes = priv->buf.sample_size * priv->buf.channels * priv->buf.consumed;
+            int copied_bytes = priv->buf.sample_size * priv->buf.channels * buf_copied;
+
+            memcpy( ((uint8_t*)buf) + copied_bytes, ((uint8_t*)priv->buf.data) + skip_bytes, copy_bytes);
+        }
         priv->buf.consumed += copy_samples;
 
         buf_copied += copy_samples;
@@ -155,6 +353,8 @@ LIBVGMSTREAM_API int64_t libvgmstream_get_play_position(libvgmstream_t* lib) {
     if (!priv->vgmstream)
         return LIBVGMSTREAM_ERROR_GENERIC;
 
+    if (priv->resampler)
+        return priv->pos.current;
     return priv->vgmstream->pstate.play_position;
 }
 
@@ -167,9 +367,16 @@ LIBVGMSTREAM_API void libvgmstream_seek(libvgmstream_t* lib, int64_t sample) {
     if (!priv->vgmstream)
         return;
 
-    seek_vgmstream(priv->vgmstream, sample);
+    // when resampling sample is at output rate
+    int64_t input_sample = api_get_input_samples(priv, sample);
+    seek_vgmstream(priv->vgmstream, input_sample);
 
-    priv->pos.current = priv->vgmstream->pstate.play_position;
+    priv->pos.input_current = priv->vgmstream->pstate.play_position;
+    if (priv->pos.input_current == input_sample)
+        priv->pos.current = sample;
+    else
+        priv->pos.current = api_get_output_samples(priv, priv->pos.input_current);
+    resampler_reset(priv->resampler, priv->pos.current);
 
     // update flags just in case
     update_buf(priv, 0);
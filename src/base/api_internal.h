@@ -4,6 +4,7 @@
 #include "../util/log.h"
 #include "../vgmstream.h"
 #include "plugins.h"
+#include "resampler.h"
 
 
 #define LIBVGMSTREAM_OK  0
@@ -11,6 +12,7 @@
 #define LIBVGMSTREAM_ERROR_DONE  -2
 
 #define INTERNAL_BUF_SAMPLES  1024
+#define INTERNAL_BUF_SAMPLES_MAX  0x10000
 
 /* self-note: various API functions are just bridges to internal stuff.
  * Rather than changing the internal stuff to handle API structs/etc,
@@ -25,6 +27,10 @@ typedef struct {
     int max_samples;
     int channels;       /* */
     int sample_size;    
+    int frame_size;     /* bytes per sample needed to render (max of input/output channels * sample size) */
+    bool planar;        /* output channels aren't interleaved (each channel takes 'samples') */
+    bool planar_render; /* stream can render planar bufs directly */
+    void* tmp;          /* render at stream's rate before resampling, or interleaved render for planar bufs */
 
     /* state */
     int samples;
@@ -38,6 +44,10 @@ typedef struct {
     int64_t play_forever;
     int64_t play_samples;
     int64_t current;
+
+    // stream values when resampling (above are output values)
+    int64_t input_play_samples;
+    int64_t input_current;
 } libvgmstream_priv_position_t;
 
 // vgmstream context/handle
@@ -52,6 +62,7 @@ typedef struct {
     VGMSTREAM* vgmstream;
     libvgmstream_priv_buf_t buf;
     libvgmstream_priv_position_t pos;
+    resampler_t* resampler;
 
     bool config_loaded;
     bool setup_done;
@@ -62,6 +73,10 @@ typedef struct {
 void libvgmstream_priv_reset(libvgmstream_priv_t* priv, bool full);
 libvgmstream_sfmt_t api_get_output_sample_type(libvgmstream_priv_t* priv);
 int api_get_sample_size(libvgmstream_sfmt_t sample_format);
+bool api_is_planar_sample_type(libvgmstream_sfmt_t sample_format);
+int api_get_render_samples(libvgmstream_priv_t* priv);
+int64_t api_get_output_samples(libvgmstream_priv_t* priv, int64_t input_samples);
+int64_t api_get_input_samples(libvgmstream_priv_t* priv, int64_t output_samples);
 void api_apply_config(libvgmstream_priv_t* priv);
 
 STREAMFILE* open_api_streamfile(libstreamfile_t* libsf);
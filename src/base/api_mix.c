@@ -0,0 +1,301 @@
+#include "api_internal.h"
+#include "sbuf.h"
+
+#define MIX_DEFAULT_CHANNELS  2
+#define MIX_DEFAULT_SAMPLE_RATE  48000
+#define MIX_DEFAULT_VOICES  32
+#define MIX_MAX_VOICES  1024
+#define MIX_MAX_CHANNELS  64
+
+typedef struct {
+    libvgmstream_t* lib;
+    bool playing;
+    int64_t delay;          // bus samples left before voice starts
+    int channels;           // voice's output channels
+    float* gains;           // [voice channels][bus channels], from gain/pan
+} mix_voice_t;
+
+typedef struct {
+    libvgmstream_mix_config_t cfg;
+
+    mix_voice_t* voices;
+    int voices_count;
+
+    float* vbuf;            // voice render buf (shared as voices render one after another)
+    int vbuf_channels;
+} libvgmstream_mix_priv_t;
+
+
+LIBVGMSTREAM_API libvgmstream_mix_t* libvgmstream_mix_init(libvgmstream_mix_config_t* cfg) {
+    libvgmstream_mix_t* mix = NULL;
+    libvgmstream_mix_priv_t* priv = NULL;
+
+    mix = calloc(1, sizeof(libvgmstream_mix_t));
+    if (!mix) goto fail;
+
+    mix->priv = calloc(1, sizeof(libvgmstream_mix_priv_t));
+    if (!mix->priv) goto fail;
+
+    priv = mix->priv;
+    if (cfg) {
+        priv->cfg = *cfg;
+    }
+
+    if (priv->cfg.channels <= 0)
+        priv->cfg.channels = MIX_DEFAULT_CHANNELS;
+    if (priv->cfg.sample_rate <= 0)
+        priv->cfg.sample_rate = MIX_DEFAULT_SAMPLE_RATE;
+    if (priv->cfg.max_voices <= 0)
+        priv->cfg.max_voices = MIX_DEFAULT_VOICES;
+    if (priv->cfg.render_samples <= 0)
+        priv->cfg.render_samples = INTERNAL_BUF_SAMPLES;
+    if (priv->cfg.channels > MIX_MAX_CHANNELS || priv->cfg.max_voices > MIX_MAX_VOICES || priv->cfg.render_samples > INTERNAL_BUF_SAMPLES_MAX)
+        goto fail;
+
+    priv->voices = calloc(priv->cfg.max_voices, sizeof(mix_voice_t));
+    if (!priv->voices) goto fail;
+    priv->voices_count = priv->cfg.max_voices;
+
+    mix->channels = priv->cfg.channels;
+    mix->sample_rate = priv->cfg.sample_rate;
+
+    return mix;
+fail:
+    libvgmstream_mix_free(mix);
+    return NULL;
+}
+
+static void free_voice(mix_voice_t* voice) {
+    libvgmstream_free(voice->lib);
+    free(voice->gains);
+    memset(voice, 0, sizeof(mix_voice_t));
+}
+
+LIBVGMSTREAM_API void libvgmstream_mix_free(libvgmstream_mix_t* mix) {
+    if (!mix)
+        return;
+
+    libvgmstream_mix_priv_t* priv = mix->priv;
+    if (priv) {
+        for (int i = 0; i < priv->voices_count; i++) {
+            free_voice(&priv->voices[i]);
+        }
+        free(priv->voices);
+        free(priv->vbuf);
+    }
+
+    free(mix->priv);
+    free(mix);
+}
+
+
+static mix_voice_t* get_voice(libvgmstream_mix_t* mix, int voice) {
+    if (!mix || !mix->priv)
+        return NULL;
+    libvgmstream_mix_priv_t* priv = mix->priv;
+
+    if (voice < 0 || voice >= priv->voices_count || !priv->voices[voice].lib)
+        return NULL;
+    return &priv->voices[voice];
+}
+
+/* Makes the voice > bus channel matrix. Channels go to the same bus channel (extra channels are dropped,
+ * downmixing beforehand if possible), with some exceptions (mono voice goes to L+R, mono bus gets all).
+ * Pan works as a balance control over L/R. */
+static void update_gains(libvgmstream_mix_priv_t* priv, mix_voice_t* voice, libvgmstream_mix_voice_t* voice_cfg) {
+    int bus_channels = priv->cfg.channels;
+    float gain = 1.0f, pan = 0.0f;
+    if (voice_cfg) {
+        gain = voice_cfg->gain;
+        pan = voice_cfg->pan;
+    }
+    if (pan < -1.0f) pan = -1.0f;
+    if (pan > 1.0f) pan = 1.0f;
+
+    float bus_gains[MIX_MAX_CHANNELS];
+    for (int ch = 0; ch < bus_channels; ch++) {
+        bus_gains[ch] = gain;
+    }
+    if (bus_channels >= 2) {
+        if (pan > 0.0f)
+            bus_gains[0] *= 1.0f - pan;
+        if (pan < 0.0f)
+            bus_gains[1] *= 1.0f + pan;
+    }
+
+    memset(voice->gains, 0, voice->channels * bus_channels * sizeof(float));
+    for (int ch = 0; ch < voice->channels; ch++) {
+        float* gains = &voice->gains[ch * bus_channels];
+
+        if (bus_channels == 1) {
+            gains[0] = bus_gains[0] / voice->channels;
+        }
+        else if (voice->channels == 1) {
+            gains[0] = bus_gains[0];
+            gains[1] = bus_gains[1];
+        }
+        else if (ch < bus_channels) {
+            gains[ch] = bus_gains[ch];
+        }
+    }
+}
+
+LIBVGMSTREAM_API int libvgmstream_mix_add_voice(libvgmstream_mix_t* mix, libstreamfile_t* libsf, int subsong, libvgmstream_config_t* cfg, libvgmstream_mix_voice_t* voice_cfg) {
+    if (!mix || !mix->priv || !libsf)
+        return LIBVGMSTREAM_ERROR_GENERIC;
+    libvgmstream_mix_priv_t* priv = mix->priv;
+
+    int index = -1;
+    for (int i = 0; i < priv->voices_count; i++) {
+        if (!priv->voices[i].lib) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0)
+        return LIBVGMSTREAM_ERROR_GENERIC;
+
+    // voices output the bus' format
+    libvgmstream_config_t vcfg = {0};
+    if (cfg) {
+        vcfg = *cfg;
+    }
+    vcfg.force_sfmt = LIBVGMSTREAM_SFMT_FLOAT;
+    vcfg.resample_rate = priv->cfg.sample_rate;
+    if (!vcfg.resample_quality)
+        vcfg.resample_quality = priv->cfg.resample_quality;
+    if (!vcfg.render_samples)
+        vcfg.render_samples = priv->cfg.render_samples;
+    if (!vcfg.auto_downmix_channels && !vcfg.stereo_track)
+        vcfg.auto_downmix_channels = priv->cfg.channels;
+
+    mix_voice_t* voice = &priv->voices[index];
+
+    voice->lib = libvgmstream_create(libsf, subsong, &vcfg);
+    if (!voice->lib) goto fail;
+
+    voice->channels = voice->lib->format->channels;
+    if (voice->channels <= 0 || voice->channels > MIX_MAX_CHANNELS)
+        goto fail;
+
+    voice->gains = malloc(voice->channels * priv->cfg.channels * sizeof(float));
+    if (!voice->gains) goto fail;
+    update_gains(priv, voice, voice_cfg);
+
+    if (priv->vbuf_channels < voice->channels) {
+        float* vbuf = realloc(priv->vbuf, priv->cfg.render_samples * voice->channels * sizeof(float));
+        if (!vbuf) goto fail;
+        priv->vbuf = vbuf;
+        priv->vbuf_channels = voice->channels;
+    }
+
+    voice->delay = voice_cfg && voice_cfg->start_offset > 0 ? voice_cfg->start_offset : 0;
+    voice->playing = true;
+
+    return index;
+fail:
+    free_voice(voice);
+    return LIBVGMSTREAM_ERROR_GENERIC;
+}
+
+LIBVGMSTREAM_API void libvgmstream_mix_remove_voice(libvgmstream_mix_t* mix, int voice) {
+    mix_voice_t* mvoice = get_voice(mix, voice);
+    if (!mvoice)
+        return;
+    free_voice(mvoice);
+}
+
+LIBVGMSTREAM_API void libvgmstream_mix_set_voice(libvgmstream_mix_t* mix, int voice, libvgmstream_mix_voice_t* voice_cfg) {
+    mix_voice_t* mvoice = get_voice(mix, voice);
+    if (!mvoice)
+        return;
+    update_gains(mix->priv, mvoice, voice_cfg);
+}
+
+LIBVGMSTREAM_API libvgmstream_t* libvgmstream_mix_get_voice(libvgmstream_mix_t* mix, int voice) {
+    mix_voice_t* mvoice = get_voice(mix, voice);
+    if (!mvoice)
+        return NULL;
+    return mvoice->lib;
+}
+
+LIBVGMSTREAM_API bool libvgmstream_mix_is_playing(libvgmstream_mix_t* mix, int voice) {
+    mix_voice_t* mvoice = get_voice(mix, voice);
+    if (!mvoice)
+        return false;
+    return mvoice->playing;
+}
+
+
+// adds rendered voice samples to bus, only for used routes
+static void mix_voice(libvgmstream_mix_priv_t* priv, mix_voice_t* voice, sbuf_t* sbus, int samples) {
+    float* dst = sbus->buf;
+    const float* src = priv->vbuf;
+    int bus_channels = sbus->channels;
+    int voice_channels = voice->channels;
+
+    dst += sbus->filled * bus_channels;
+    for (int ch_src = 0; ch_src < voice_channels; ch_src++) {
+        for (int ch_dst = 0; ch_dst < bus_channels; ch_dst++) {
+            float gain = voice->gains[ch_src * bus_channels + ch_dst];
+            if (gain == 0.0f)
+                continue;
+
+            for (int s = 0; s < samples; s++) {
+                dst[s * bus_channels + ch_dst] += src[s * voice_channels + ch_src] * gain;
+            }
+        }
+    }
+}
+
+static void render_voice(libvgmstream_mix_priv_t* priv, mix_voice_t* voice, float* buf, int buf_samples) {
+    sbuf_t sbus;
+    sbuf_init(&sbus, SFMT_FLT, buf, buf_samples, priv->cfg.channels);
+
+    if (voice->delay > 0) {
+        int skip = voice->delay > buf_samples ? buf_samples : (int)voice->delay;
+        voice->delay -= skip;
+        sbus.filled += skip;
+    }
+
+    while (sbus.filled < sbus.samples) {
+        int to_get = sbus.samples - sbus.filled;
+        if (to_get > priv->cfg.render_samples)
+            to_get = priv->cfg.render_samples;
+
+        int err = libvgmstream_fill(voice->lib, priv->vbuf, to_get);
+        if (err < 0) {
+            voice->playing = false;
+            break;
+        }
+
+        int done = voice->lib->decoder->buf_samples;
+        mix_voice(priv, voice, &sbus, done);
+        sbus.filled += done;
+
+        if (voice->lib->decoder->done || done == 0) {
+            voice->playing = false;
+            break;
+        }
+    }
+}
+
+LIBVGMSTREAM_API int libvgmstream_mix_render(libvgmstream_mix_t* mix, float* buf, int buf_samples) {
+    if (!mix || !mix->priv || !buf || buf_samples < 0)
+        return LIBVGMSTREAM_ERROR_GENERIC;
+    libvgmstream_mix_priv_t* priv = mix->priv;
+
+    sbuf_t sbus;
+    sbuf_init(&sbus, SFMT_FLT, buf, buf_samples, priv->cfg.channels);
+    sbuf_silence_rest(&sbus);
+
+    for (int i = 0; i < priv->voices_count; i++) {
+        mix_voice_t* voice = &priv->voices[i];
+        if (!voice->lib || !voice->playing)
+            continue;
+
+        render_voice(priv, voice, buf, buf_samples);
+    }
+
+    return buf_samples;
+}
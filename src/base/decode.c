@@ -50,6 +50,10 @@ void decode_free(VGMSTREAM* vgmstream) {
         free_circus_vq(vgmstream->codec_data);
     }
 
+    if (vgmstream->coding_type == coding_G721) {
+        free_g721(vgmstream->codec_data);
+    }
+
     if (vgmstream->coding_type == coding_RELIC) {
         free_relic(vgmstream->codec_data);
     }
@@ -143,6 +147,10 @@ void decode_seek(VGMSTREAM* vgmstream) {
         seek_circus_vq(vgmstream->codec_data, vgmstream->loop_current_sample);
     }
 
+    if (vgmstream->coding_type == coding_G721) {
+        seek_g721(vgmstream->codec_data);
+    }
+
     if (vgmstream->coding_type == coding_RELIC) {
         seek_relic(vgmstream->codec_data, vgmstream->loop_current_sample);
     }
@@ -220,6 +228,10 @@ void decode_reset(VGMSTREAM* vgmstream) {
         reset_circus_vq(vgmstream->codec_data);
     }
 
+    if (vgmstream->coding_type == coding_G721) {
+        reset_g721(vgmstream->codec_data);
+    }
+
     if (vgmstream->coding_type == coding_RELIC) {
         reset_relic(vgmstream->codec_data);
     }
@@ -1019,7 +1031,7 @@ void decode_vgmstream(sbuf_t* sdst, VGMSTREAM* vgmstream, int samples_to_do) {
             break;
         case coding_G721:
             for (ch = 0; ch < vgmstream->channels; ch++) {
-                decode_g721(&vgmstream->ch[ch], buffer+ch,
+                decode_g721(&vgmstream->ch[ch], vgmstream->codec_data, ch, buffer+ch,
                         vgmstream->channels, vgmstream->samples_into_block, samples_to_do);
             }
             break;
@@ -1537,6 +1549,15 @@ void decode_vgmstream(sbuf_t* sdst, VGMSTREAM* vgmstream, int samples_to_do) {
     }
 }
 
+bool decode_supports_planar(VGMSTREAM* vgmstream) {
+    if (vgmstream->coding_type == coding_SILENCE)
+        return true;
+
+    // frame decoders have their own buf that is copied to sdst (decode_buf ones write directly)
+    const codec_info_t* codec_info = codec_get_info(vgmstream);
+    return codec_info && codec_info->decode_frame && !codec_info->decode_buf;
+}
+
 /* Calculate number of consecutive samples we can decode. Takes into account hitting
  * a loop start or end, or going past a single frame. */
 int decode_get_samples_to_do(int samples_this_block, int samples_per_frame, VGMSTREAM* vgmstream) {
@@ -1651,6 +1672,11 @@ bool decode_do_loop(VGMSTREAM* vgmstream) {
         vgmstream->loop_next_block_offset = vgmstream->next_block_offset;
         vgmstream->loop_full_block_size = vgmstream->full_block_size;
 
+        /* codecs with per-channel state outside loop_ch */
+        if (vgmstream->coding_type == coding_G721) {
+            loop_g721(vgmstream->codec_data);
+        }
+
         /* play state is applied over loops and stream decoding, so it's not saved on loops */
         //vgmstream->lstate = vgmstream->pstate;
 
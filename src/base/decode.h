@@ -12,6 +12,9 @@ void decode_reset(VGMSTREAM* vgmstream);
  * buffer already, and we have samples_to_do consecutive samples ahead of us. */
 void decode_vgmstream(sbuf_t* sdst, VGMSTREAM* vgmstream, int samples_to_do);
 
+/* Whether decode_vgmstream can write into a planar sbuf (old-style decoders only write interleaved samples). */
+bool decode_supports_planar(VGMSTREAM* vgmstream);
+
 /* Detect loop start and save values, or detect loop end and restore (loop back). Returns true if loop was done. */
 bool decode_do_loop(VGMSTREAM* vgmstream);
 
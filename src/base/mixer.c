@@ -29,7 +29,6 @@ mixer_t* mixer_init(int channels) {
     mixer_t* mixer = calloc(1, sizeof(mixer_t));
     if (!mixer) goto fail;
 
-    mixer->chain_size = VGMSTREAM_MAX_MIXING; /* fixed array for now */
     mixer->mixing_channels = channels;
     mixer->output_channels = channels;
     mixer->input_channels = channels;
@@ -44,6 +43,7 @@ fail:
 void mixer_free(mixer_t* mixer) {
     if (!mixer) return;
 
+    free(mixer->chain);
     free(mixer->mixbuf);
     free(mixer);
 }
@@ -123,6 +123,18 @@ void mixer_process(mixer_t* mixer, sbuf_t* sbuf, int32_t current_pos) {
 
     mixer->current_subpos = current_pos;
 
+    // routing-only chains (common for TXTP channel masks and layout fixes) are done in the original buf
+    if (mixer_op_route(mixer, sbuf))
+        return;
+
+    if (!mixer->mixbuf) {
+        mixer->mixbuf = malloc(mixer->mixbuf_samples * mixer->mixing_channels * sizeof(float));
+        if (!mixer->mixbuf) {
+            VGM_LOG_ONCE("MIXER: can't allocate mixbuf\n");
+            return;
+        }
+    }
+
     setup_mixbuf(mixer, sbuf);
 
     // apply mixing ops in order. channels in mixers may increase or decrease per op (set in sbuf)
@@ -1,10 +1,7 @@
 #include "mixer_priv.h"
+#include "../util/vgmstream_limits.h"
 
 
-// TO-DO: some ops can be done with original PCM sbuf to avoid copying to the float sbuf
-// when there are no actual float ops (ex. 'swap', if no ' volume' )
-// Performance gain is probably fairly small, though.
-
 void mixer_op_swap(mixer_t* mixer, mix_op_t* op) {
     sbuf_t* smix = &mixer->smix;
     float* dst = smix->buf;
@@ -149,3 +146,111 @@ void mixer_op_killmix(mixer_t* mixer, mix_op_t* op) {
         src += max_channels;
     }
 }
+
+
+/* Chains that only move channels around (swap, insert silent channel, remove channels) don't need
+ * float ops, so they are collapsed into a single map (output channel N = input channel M or silence)
+ * and applied over the original PCM buf, skipping the float mixbuf round trip. */
+static bool get_route_map(mixer_t* mixer, int* map, int input_channels, int* p_output_channels) {
+    int channels = input_channels;
+
+    if (channels > VGMSTREAM_MAX_CHANNELS)
+        return false;
+    for (int ch = 0; ch < channels; ch++) {
+        map[ch] = ch;
+    }
+
+    for (int m = 0; m < mixer->chain_count; m++) {
+        mix_op_t* op = &mixer->chain[m];
+
+        switch(op->type) {
+            case MIX_SWAP: {
+                int temp = map[op->ch_dst];
+                map[op->ch_dst] = map[op->ch_src];
+                map[op->ch_src] = temp;
+                break;
+            }
+
+            case MIX_UPMIX:
+                if (channels + 1 > VGMSTREAM_MAX_CHANNELS)
+                    return false;
+                for (int ch = channels; ch > op->ch_dst; ch--) {
+                    map[ch] = map[ch - 1];
+                }
+                map[op->ch_dst] = -1; // inserted as silent
+                channels++;
+                break;
+
+            case MIX_DOWNMIX:
+                for (int ch = op->ch_dst; ch < channels - 1; ch++) {
+                    map[ch] = map[ch + 1];
+                }
+                channels--;
+                break;
+
+            case MIX_KILLMIX:
+                channels = op->ch_dst;
+                break;
+
+            default: // has float ops
+                return false;
+        }
+    }
+
+    *p_output_channels = channels;
+    return true;
+}
+
+#define DEFINE_MIXER_ROUTE(suffix, buftype) \
+    static void mixer_route_##suffix(sbuf_t* sbuf, int* map, int input_channels, int output_channels) { \
+        buftype* buf = sbuf->buf; \
+        buftype frame[VGMSTREAM_MAX_CHANNELS]; \
+        /* going forward output frame is never ahead of current input frame when channels don't increase, */ \
+        /* otherwise copy 'backwards' as it would overwrite samples before moving them */ \
+        bool forward = output_channels <= input_channels; \
+        for (int i = 0; i < sbuf->filled; i++) { \
+            int s = forward ? i : sbuf->filled - 1 - i; \
+            buftype* src = buf + s * input_channels; \
+            buftype* dst = buf + s * output_channels; \
+            for (int ch = 0; ch < input_channels; ch++) { \
+                frame[ch] = src[ch]; \
+            } \
+            for (int ch = 0; ch < output_channels; ch++) { \
+                dst[ch] = map[ch] < 0 ? 0 : frame[map[ch]]; \
+            } \
+        } \
+    }
+
+DEFINE_MIXER_ROUTE(i16, int16_t);
+DEFINE_MIXER_ROUTE(i32, int32_t);
+
+bool mixer_op_route(mixer_t* mixer, sbuf_t* sbuf) {
+    int map[VGMSTREAM_MAX_CHANNELS];
+    int input_channels = sbuf->channels;
+    int output_channels = 0;
+
+    if (sbuf->planar)
+        return false;
+    if (mixer->force_type != SFMT_NONE && mixer->force_type != sbuf->fmt)
+        return false;
+    if (!get_route_map(mixer, map, input_channels, &output_channels))
+        return false;
+
+    // samples are only moved, so format doesn't matter other than size (silence is 0 in all)
+    switch(sbuf->fmt) {
+        case SFMT_S16:
+            mixer_route_i16(sbuf, map, input_channels, output_channels);
+            break;
+        case SFMT_S24:
+        case SFMT_S32:
+        case SFMT_FLT:
+        case SFMT_F16:
+            mixer_route_i32(sbuf, map, input_channels, output_channels);
+            break;
+        default:
+            return false;
+    }
+
+    sbuf->channels = output_channels;
+    return true;
+}
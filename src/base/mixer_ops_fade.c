@@ -2,9 +2,8 @@
 #include <limits.h>
 #include <math.h>
 
-//TODO: could precalculate tables + interpolate for some performance gain
-
 #define MIXING_PI   3.14159265358979323846f
+#define FADE_EXP_K  5.75646273248511f  /* -2.5 * ln(0.1) */
 
 static inline float get_fade_gain_curve(char shape, float index) {
     float gain;
@@ -14,8 +13,6 @@ static inline float get_fade_gain_curve(char shape, float index) {
         return index;
     }
 
-    //TODO optimizations: interleave calcs
-
     /* (curve math mostly from SoX/FFmpeg) */
     switch(shape) {
         /* 2.5f in L/E 'pow' is the attenuation factor, where 5.0 (100db) is common but a bit fast
@@ -23,12 +20,12 @@ static inline float get_fade_gain_curve(char shape, float index) {
 
         case 'E': /* exponential (for fade-outs, closer to natural decay of sound) */
             //gain = powf(0.1f, (1.0f - index) * 2.5f);
-            gain = expf(-5.75646273248511f * (1.0f - index));
+            gain = expf(-FADE_EXP_K * (1.0f - index));
             break;
 
         case 'L': /* logarithmic (inverse of the above, maybe for crossfades) */
             //gain = 1 - powf(0.1f, (index) * 2.5f);
-            gain = 1 - expf(-5.75646273248511f * (index));
+            gain = 1 - expf(-FADE_EXP_K * (index));
             break;
 
         case 'H': /* raised sine wave or cosine wave (for more musical crossfades) */
@@ -56,7 +53,107 @@ static inline float get_fade_gain_curve(char shape, float index) {
     return gain;
 }
 
-static bool get_fade_gain(mix_op_t* op, float* out_cur_vol, int32_t current_subpos) {
+/* Since index moves linearly per sample, transcendental curves can be stepped with recurrences
+ * (exp(a+d) = exp(a)*exp(d), cos(a+d) = 2*cos(d)*cos(a) - cos(a-d), same for sin) rather than
+ * calling expf/cosf per sample. Started with the exact value on each mix call, so error stays tiny
+ * (double precision, max one mixbuf of steps). Other shapes are cheap and calculated directly. */
+typedef struct {
+    bool ready;
+    char shape;
+    int32_t range_idx;
+    int32_t range_step;
+    float range_dur;
+
+    bool recurrent;
+    bool second_order;
+    double cur;             /* curve value at current index: exp() for E/L, cos() for H, sin() for Q */
+    double prev;            /* value at previous index (second order) */
+    double mul;             /* next = mul * cur (- prev) */
+} fade_curve_t;
+
+static void fade_curve_init(fade_curve_t* fc, mix_op_t* op, int32_t current_subpos) {
+    bool fade_in = op->vol_start < op->vol_end;
+
+    fc->ready = true;
+    fc->shape = op->shape;
+    fc->range_dur = op->time_end - op->time_start;
+    if (fade_in) {
+        fc->range_idx = current_subpos - op->time_start;
+        fc->range_step = 1;
+    } else {
+        fc->range_idx = op->time_end - current_subpos;
+        fc->range_step = -1;
+    }
+
+    double index = (double)fc->range_idx / fc->range_dur;
+    double step = (double)fc->range_step / fc->range_dur;
+
+    fc->recurrent = true;
+    fc->second_order = false;
+    switch(fc->shape) {
+        case 'E':
+            fc->cur = exp(-FADE_EXP_K * (1.0 - index));
+            fc->mul = exp(FADE_EXP_K * step);
+            break;
+        case 'L':
+            fc->cur = exp(-FADE_EXP_K * index);
+            fc->mul = exp(-FADE_EXP_K * step);
+            break;
+        case 'H':
+            fc->second_order = true;
+            fc->cur = cos(index * MIXING_PI);
+            fc->prev = cos((index - step) * MIXING_PI);
+            fc->mul = 2.0 * cos(step * MIXING_PI);
+            break;
+        case 'Q':
+            fc->second_order = true;
+            fc->cur = sin(index * MIXING_PI / 2.0);
+            fc->prev = sin((index - step) * MIXING_PI / 2.0);
+            fc->mul = 2.0 * cos(step * MIXING_PI / 2.0);
+            break;
+        default:
+            fc->recurrent = false;
+            break;
+    }
+}
+
+/* same as get_fade_gain_curve for current index, then moves to next sample */
+static inline float fade_curve_next(fade_curve_t* fc) {
+    float index = fc->range_idx / fc->range_dur;
+    float gain;
+
+    if (!fc->recurrent) {
+        gain = get_fade_gain_curve(fc->shape, index);
+    }
+    else {
+        if (index <= 0.0001f || index >= 0.9999f) {
+            gain = index;
+        }
+        else {
+            switch(fc->shape) {
+                case 'E': gain = fc->cur; break;
+                case 'L': gain = 1 - fc->cur; break;
+                case 'H': gain = (1.0f - fc->cur) / 2.0f; break;
+                case 'Q':
+                default:  gain = fc->cur; break;
+            }
+        }
+
+        if (fc->second_order) {
+            double next = fc->mul * fc->cur - fc->prev;
+            fc->prev = fc->cur;
+            fc->cur = next;
+        }
+        else {
+            fc->cur *= fc->mul;
+        }
+    }
+
+    fc->range_idx += fc->range_step;
+    return gain;
+}
+
+static bool get_fade_gain(mix_op_t* op, fade_curve_t* fc, float* out_cur_vol, int32_t current_subpos) {
     float cur_vol = 0.0f;
 
     if ((current_subpos >= op->time_pre || op->time_pre < 0) && current_subpos < op->time_start) {
@@ -67,19 +164,9 @@ static bool get_fade_gain(mix_op_t* op, float* out_cur_vol, int32_t current_subp
     }
     else if (current_subpos >= op->time_start && current_subpos < op->time_end) {
         /* in between */
-        float range_vol, range_dur, range_idx, index, gain;
+        float range_vol, gain;
 
-        if (op->vol_start < op->vol_end) { /* fade in */
-            range_vol = op->vol_end - op->vol_start;
-            range_dur = op->time_end - op->time_start;
-            range_idx = current_subpos - op->time_start;
-            index = range_idx / range_dur;
-        } else { /* fade out */
-            range_vol = op->vol_end - op->vol_start;
-            range_dur = op->time_end - op->time_start;
-            range_idx = op->time_end - current_subpos;
-            index = range_idx / range_dur;
-        }
+        range_vol = op->vol_end - op->vol_start;
 
         /* Fading is done like this:
          * - find current position within fade duration
@@ -97,7 +184,9 @@ static bool get_fade_gain(mix_op_t* op, float* out_cur_vol, int32_t current_subp
          * curves are complementary (exponential fade-in ~= logarithmic fade-out); the following
          * are described taking fade-in = normal.
          */
-        gain = get_fade_gain_curve(op->shape, index);
+        if (!fc->ready)
+            fade_curve_init(fc, op, current_subpos);
+        gain = fade_curve_next(fc);
 
         if (op->vol_start < op->vol_end) {  /* fade in */
             cur_vol = op->vol_start + range_vol * gain;
@@ -121,10 +210,11 @@ void mixer_op_fade(mixer_t* mixer, mix_op_t* mix) {
 
     int channels = smix->channels;
     int32_t current_subpos = mixer->current_subpos;
+    fade_curve_t fc = {0}; /* fade part is contiguous, so curve is stepped once per sample there */
 
     //TODO optimize for case 0?
     for (int s = 0; s < smix->filled; s++) {
-        bool fade_applies = get_fade_gain(mix, &new_gain, current_subpos);
+        bool fade_applies = get_fade_gain(mix, &fc, &new_gain, current_subpos);
         if (!fade_applies) { //TODO optimize?
             dst += channels;
             current_subpos++;
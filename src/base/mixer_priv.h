@@ -42,14 +42,15 @@ struct mixer_t {
     bool active;            /* mixing working */
 
     int chain_count;        /* op number */
-    size_t chain_size;      /* max ops */
-    mix_op_t chain[VGMSTREAM_MAX_MIXING]; /* effects to apply (could be alloc'ed but to simplify...) */
+    size_t chain_size;      /* allocated ops (grows up to VGMSTREAM_MAX_MIXING) */
+    mix_op_t* chain;        /* effects to apply */
 
     /* fades only apply at some points, other mixes are active */
     bool has_non_fade;
     bool has_fade;
 
-    float* mixbuf;          // internal mixing buffer
+    float* mixbuf;          // internal mixing buffer (allocated on first mix)
+    int mixbuf_samples;     // max samples per mix
     sbuf_t smix;            // temp sbuf
     int32_t current_subpos; // state: current sample pos in the stream
 
@@ -65,4 +66,5 @@ void mixer_op_downmix(mixer_t* mixer, mix_op_t* op);
 void mixer_op_killmix(mixer_t* mixer, mix_op_t* op);
 void mixer_op_fade(mixer_t* mixer, mix_op_t* op);
 bool mixer_op_fade_is_active(mixer_t* mixer, int32_t current_start, int32_t current_end);
+bool mixer_op_route(mixer_t* mixer, sbuf_t* sbuf);
 #endif
@@ -44,8 +44,26 @@ void mix_vgmstream(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
 
 /* ******************************************************************* */
 
-static int fix_layered_channel_layout(VGMSTREAM* vgmstream) {
-    mixer_t* mixer = vgmstream->mixer;
+mixer_t* mixing_get_mixer(VGMSTREAM* vgmstream) {
+    if (vgmstream->mixer)
+        return vgmstream->mixer;
+
+    if (vgmstream->mixing_ready) {
+        VGM_LOG("MIX: ignoring new ops when mixer is active\n");
+        return NULL; /* to avoid down/upmixing after activation */
+    }
+
+    mixer_t* mixer = mixer_init(vgmstream->channels);
+    if (!mixer)
+        return NULL;
+
+    /* may be created after setup_vgmstream */
+    vgmstream->mixer = mixer;
+    ((VGMSTREAM*)vgmstream->start_vgmstream)->mixer = mixer;
+    return mixer;
+}
+
+static int fix_layered_channel_layout(VGMSTREAM* vgmstream, int output_channels) {
     layered_layout_data* layout_data;
     uint32_t prev_cl;
 
@@ -55,7 +73,7 @@ static int fix_layered_channel_layout(VGMSTREAM* vgmstream) {
     layout_data = vgmstream->layout_data;
 
     /* mainly layer-v (in cases of layers-within-layers should cascade) */
-    if (mixer->output_channels != layout_data->layers[0]->channels)
+    if (output_channels != layout_data->layers[0]->channels)
         return 0;
 
     /* check all layers share layout (implicitly works as a channel check, if not 0) */
@@ -77,15 +95,16 @@ static int fix_layered_channel_layout(VGMSTREAM* vgmstream) {
 
 /* channel layout + down/upmixing = ?, salvage what we can */
 static void fix_channel_layout(VGMSTREAM* vgmstream) {
-    mixer_t* mixer = vgmstream->mixer;
+    int output_channels = 0;
+    mixing_info(vgmstream, NULL, &output_channels);
 
-    if (fix_layered_channel_layout(vgmstream))
+    if (fix_layered_channel_layout(vgmstream, output_channels))
         goto done;
 
     /* segments should share channel layout automatically */
 
     /* a bit wonky but eh... */
-    if (vgmstream->channel_layout && vgmstream->channels != mixer->output_channels) {
+    if (vgmstream->channel_layout && vgmstream->channels != output_channels) {
         vgmstream->channel_layout = 0;
     }
 
@@ -97,18 +116,24 @@ done:
 void mixing_setup(VGMSTREAM* vgmstream, int32_t max_sample_count) {
     mixer_t* mixer = vgmstream->mixer;
 
-    if (!mixer)
-        return;
-
     /* special value to not actually enable anything (used to query values) */
     if (max_sample_count <= 0)
         return;
 
-    /* create or alter internal buffer */
-    float* mixbuf_re = realloc(mixer->mixbuf, max_sample_count * mixer->mixing_channels * sizeof(float));
-    if (!mixbuf_re) goto fail;
+    /* mixer isn't created if nothing was added, no need to mix but new ops must be ignored too */
+    vgmstream->mixing_ready = true;
+    ((VGMSTREAM*)vgmstream->start_vgmstream)->mixing_ready = true;
+    if (!mixer) {
+        fix_channel_layout(vgmstream);
+        return;
+    }
 
-    mixer->mixbuf = mixbuf_re;
+    /* internal buffer is created on first mix (streams may be opened just for info) */
+    if (mixer->mixbuf_samples < max_sample_count) {
+        free(mixer->mixbuf);
+        mixer->mixbuf = NULL;
+        mixer->mixbuf_samples = max_sample_count;
+    }
     mixer->active = true;
 
     fix_channel_layout(vgmstream);
@@ -117,10 +142,6 @@ void mixing_setup(VGMSTREAM* vgmstream, int32_t max_sample_count) {
      * there is no need to propagate to start_vgmstream */
 
     /* segments/layers are independant from external buffers and may always mix */
-
-    return;
-fail:
-    return;
 }
 
 void mixing_info(VGMSTREAM* vgmstream, int* p_input_channels, int* p_output_channels) {
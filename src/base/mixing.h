@@ -4,6 +4,7 @@
 #include "../vgmstream.h"
 #include "../util/log.h" //TODO remove
 #include "sbuf.h"
+#include "mixer.h"
 
 /* Applies mixing commands to the sample buffer. Mixing must be externally enabled and
  * outbuf must big enough to hold output_channels*samples_to_do */
@@ -14,6 +15,9 @@ void mix_vgmstream(sbuf_t* sbuf, VGMSTREAM* vgmstream);
  * of down/upmixing without querying input/output_channels). */
 void mixing_setup(VGMSTREAM* vgmstream, int32_t max_sample_count);
 
+/* gets vgmstream's mixer, created on first use (most vgmstreams never mix, like most layers/segments) */
+mixer_t* mixing_get_mixer(VGMSTREAM* vgmstream);
+
 /* gets current mixing info */
 void mixing_info(VGMSTREAM* vgmstream, int* input_channels, int* output_channels);
 
@@ -4,9 +4,11 @@
 #include <math.h>
 #include <limits.h>
 
+#define MIXING_CHAIN_MIN  16
+
 
 static bool add_mixing(VGMSTREAM* vgmstream, mix_op_t* op) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     if (!mixer)
         return false;
 
@@ -16,9 +18,21 @@ static bool add_mixing(VGMSTREAM* vgmstream, mix_op_t* op) {
         return false; /* to avoid down/upmixing after activation */
     }
 
+    /* chain grows as needed as most mixers have just a few ops */
     if (mixer->chain_count + 1 > mixer->chain_size) {
-        VGM_LOG("MIX: too many mixes\n");
-        return false;
+        if (mixer->chain_size >= VGMSTREAM_MAX_MIXING) {
+            VGM_LOG("MIX: too many mixes\n");
+            return false;
+        }
+
+        size_t chain_size = mixer->chain_size ? mixer->chain_size * 2 : MIXING_CHAIN_MIN;
+        if (chain_size > VGMSTREAM_MAX_MIXING)
+            chain_size = VGMSTREAM_MAX_MIXING;
+
+        mix_op_t* chain = realloc(mixer->chain, chain_size * sizeof(mix_op_t));
+        if (!chain) return false;
+        mixer->chain = chain;
+        mixer->chain_size = chain_size;
     }
 
     mixer->chain[mixer->chain_count] = *op; /* memcpy */
@@ -38,7 +52,7 @@ static bool add_mixing(VGMSTREAM* vgmstream, mix_op_t* op) {
 
 
 void mixing_push_swap(VGMSTREAM* vgmstream, int ch_dst, int ch_src) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
 
     if (ch_dst < 0 || ch_src < 0 || ch_dst == ch_src) return;
@@ -51,7 +65,7 @@ void mixing_push_swap(VGMSTREAM* vgmstream, int ch_dst, int ch_src) {
 }
 
 void mixing_push_add(VGMSTREAM* vgmstream, int ch_dst, int ch_src, double volume) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
     if (!mixer) return;
 
@@ -70,7 +84,7 @@ void mixing_push_add(VGMSTREAM* vgmstream, int ch_dst, int ch_src, double volume
 }
 
 void mixing_push_volume(VGMSTREAM* vgmstream, int ch_dst, double volume) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
 
     //if (ch_dst < 0) return; /* means all channels */
@@ -87,7 +101,7 @@ void mixing_push_volume(VGMSTREAM* vgmstream, int ch_dst, double volume) {
 }
 
 void mixing_push_limit(VGMSTREAM* vgmstream, int ch_dst, double volume) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
 
     //if (ch_dst < 0) return; /* means all channels */
@@ -104,7 +118,7 @@ void mixing_push_limit(VGMSTREAM* vgmstream, int ch_dst, double volume) {
 }
 
 void mixing_push_upmix(VGMSTREAM* vgmstream, int ch_dst) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
     int ok;
 
@@ -124,7 +138,7 @@ void mixing_push_upmix(VGMSTREAM* vgmstream, int ch_dst) {
 }
 
 void mixing_push_downmix(VGMSTREAM* vgmstream, int ch_dst) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
     int ok;
 
@@ -141,7 +155,7 @@ void mixing_push_downmix(VGMSTREAM* vgmstream, int ch_dst) {
 }
 
 void mixing_push_killmix(VGMSTREAM* vgmstream, int ch_dst) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
 
     if (ch_dst <= 0) return; /* can't kill from first channel */
@@ -173,7 +187,7 @@ static mix_op_t* get_last_fade(mixer_t* mixer, int target_channel) {
 
 void mixing_push_fade(VGMSTREAM* vgmstream, int ch_dst, double vol_start, double vol_end, char shape,
         int32_t time_pre, int32_t time_start, int32_t time_end, int32_t time_post) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     mix_op_t op = {0};
     mix_op_t* op_prev;
 
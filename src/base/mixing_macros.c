@@ -12,7 +12,7 @@
 #define MIX_MACRO_BGM     'b'
 
 void mixing_macro_volume(VGMSTREAM* vgmstream, double volume, uint32_t mask) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     if (!mixer)
         return;
 
@@ -29,7 +29,7 @@ void mixing_macro_volume(VGMSTREAM* vgmstream, double volume, uint32_t mask) {
 }
 
 void mixing_macro_track(VGMSTREAM* vgmstream, uint32_t mask) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     if (!mixer)
         return;
 
@@ -75,7 +75,7 @@ static int is_layered_auto(VGMSTREAM* vgmstream, int max, char mode) {
         return 0;
 
     /* no channel down/upmixing (cannot guess output) */
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     for (int i = 0; i < mixer->chain_count; i++) {
         mix_type_t type = mixer->chain[i].type;
         if (type == MIX_UPMIX || type == MIX_DOWNMIX || type == MIX_KILLMIX) /*type == MIX_SWAP || ??? */
@@ -209,7 +209,7 @@ static void mixing_macro_layer_auto(VGMSTREAM* vgmstream, int max, char mode) {
 
 
 void mixing_macro_layer(VGMSTREAM* vgmstream, int max, uint32_t mask, char mode) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     int current, ch, output_channels, selected_channels;
 
     if (!mixer)
@@ -293,7 +293,7 @@ void mixing_macro_layer(VGMSTREAM* vgmstream, int max, uint32_t mask, char mode)
 }
 
 void mixing_macro_crosstrack(VGMSTREAM* vgmstream, int max) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     int current, ch, track, track_ch, track_num, output_channels;
     int32_t change_pos, change_next, change_time;
 
@@ -357,7 +357,7 @@ void mixing_macro_crosstrack(VGMSTREAM* vgmstream, int max) {
 }
 
 void mixing_macro_crosslayer(VGMSTREAM* vgmstream, int max, char mode) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     int current, ch, layer, layer_ch, layer_num, loop, output_channels;
     int32_t change_pos, change_time;
 
@@ -470,7 +470,7 @@ typedef enum {
 } mixing_position_t;
 
 void mixing_macro_downmix(VGMSTREAM* vgmstream, int max /*, mapping_t output_mapping*/) {
-    mixer_t* mixer = vgmstream->mixer;
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
     int output_channels, mp_in, mp_out, ch_in, ch_out;
     channel_mapping_t input_mapping, output_mapping;
     const double vol_max = 1.0;
@@ -568,14 +568,17 @@ void mixing_macro_downmix(VGMSTREAM* vgmstream, int max /*, mapping_t output_map
 
 
 void mixing_macro_output_sample_format(VGMSTREAM* vgmstream, sfmt_t type) {
-    mixer_t* mixer = vgmstream->mixer;
-    if (!mixer || !type)
+    if (!type)
         return;
 
     // optimization (may skip initializing mixer)
     sfmt_t input_fmt = mixing_get_input_sample_type(vgmstream);
     if (input_fmt == type)
         return;
+
+    mixer_t* mixer = mixing_get_mixer(vgmstream);
+    if (!mixer)
+        return;
     mixer->force_type = type;
     mixer->has_non_fade = true;
 }
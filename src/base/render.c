@@ -49,6 +49,8 @@
 /*****************************************************************************/
 
 void render_free(VGMSTREAM* vgmstream) {
+    blocked_index_free(vgmstream);
+
     if (!vgmstream->layout_data)
         return;
 
@@ -72,6 +74,17 @@ void render_reset(VGMSTREAM* vgmstream) {
     }
 }
 
+bool render_supports_planar(VGMSTREAM* vgmstream) {
+    switch (vgmstream->layout_type) {
+        case layout_segmented:
+        case layout_layered:
+            // sub-vgmstreams are rendered into an internal buf then copied
+            return true;
+        default:
+            return decode_supports_planar(vgmstream);
+    }
+}
+
 int render_layout(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
     int sample_count = sbuf->samples;
 
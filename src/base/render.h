@@ -9,5 +9,8 @@ void render_reset(VGMSTREAM* vgmstream);
 int render_layout(sbuf_t* sbuf, VGMSTREAM* vgmstream);
 int render_main(sbuf_t* sbuf, VGMSTREAM* vgmstream);
 
+/* Whether render_main accepts a planar sbuf for this vgmstream (otherwise must render interleaved and convert) */
+bool render_supports_planar(VGMSTREAM* vgmstream);
+
 
 #endif
@@ -0,0 +1,304 @@
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../util.h"
+#include "../util/log.h"
+#include "resampler.h"
+
+/* Polyphase resampler: output samples are made by convolving input with a windowed sinc filter, which is
+ * precalculated for N fractional positions (phases) between 2 input samples. Output position moves by
+ * input_rate/output_rate input samples, tracked as an exact fraction to avoid drifting after long playback.
+ * Current fractional position falls between 2 phases, whose coefs are linearly interpolated.
+ *
+ * Input history is kept as planar float, so each output sample is a contiguous dot product per channel
+ * (written to be easily vectorized by compilers). Filter is centered on current sample, so output isn't
+ * delayed but needs a few samples of lookahead (flushed with silence at the end).
+ */
+
+#define RESAMPLER_PHASES 256
+#define RESAMPLER_MAX_TAPS 256
+
+struct resampler_t {
+    int channels;
+    int input_rate;     // reduced by gcd
+    int output_rate;
+
+    /* filter */
+    int taps;           // per phase, multiple of 4
+    float* coefs;       // [phases + 1][taps]
+
+    /* input history (planar float, 'hist_size' per channel) */
+    float* hist;
+    int hist_size;
+    int hist_start;     // first tap of current output sample
+    int hist_end;       // next input sample
+    int frac;           // current fractional position, as N/output_rate
+    sfmt_t fmt;         // float flavor of pushed samples (F16 for S16 keeps 1:1 values)
+
+    /* output */
+    float* obuf;
+    int obuf_size;
+};
+
+
+static int get_gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static double sinc(double x) {
+    if (fabs(x) < 1e-9)
+        return 1.0;
+    return sin(M_PI * x) / (M_PI * x);
+}
+
+// Blackman window, x in -1..1
+static double window(double x) {
+    if (x <= -1.0 || x >= 1.0)
+        return 0.0;
+    return 0.42 + 0.5 * cos(M_PI * x) + 0.08 * cos(2.0 * M_PI * x);
+}
+
+static bool init_filter(resampler_t* rs, int quality) {
+    int half_taps;
+    double rolloff;
+    switch(quality) {
+        case 1:  half_taps = 4;  rolloff = 0.85; break;
+        case 3:  half_taps = 16; rolloff = 0.96; break;
+        case 2:
+        default: half_taps = 8;  rolloff = 0.92; break;
+    }
+
+    // when downsampling cutoff must go below output's nyquist, which needs a longer filter for the same quality
+    double ratio = (double)rs->output_rate / rs->input_rate;
+    if (ratio > 1.0)
+        ratio = 1.0;
+    double cutoff = ratio * rolloff;
+
+    half_taps = (int)ceil(half_taps / ratio);
+    int taps = (half_taps * 2 + 3) & ~3;
+    if (taps > RESAMPLER_MAX_TAPS)
+        taps = RESAMPLER_MAX_TAPS;
+    half_taps = taps / 2;
+    rs->taps = taps;
+
+    rs->coefs = malloc((RESAMPLER_PHASES + 1) * taps * sizeof(float));
+    if (!rs->coefs) return false;
+
+    // tap i of phase p is at distance (i - (half_taps - 1) - p/phases) from current sample
+    for (int p = 0; p <= RESAMPLER_PHASES; p++) {
+        float* coefs = &rs->coefs[p * taps];
+        double pos = (double)p / RESAMPLER_PHASES;
+        double sum = 0.0;
+
+        for (int i = 0; i < taps; i++) {
+            double t = i - (half_taps - 1) - pos;
+            double h = cutoff * sinc(cutoff * t) * window(t / half_taps);
+            coefs[i] = (float)h;
+            sum += h;
+        }
+
+        // normalize so DC passes unchanged
+        for (int i = 0; i < taps; i++) {
+            coefs[i] = (float)(coefs[i] / sum);
+        }
+    }
+
+    return true;
+}
+
+resampler_t* resampler_init(int channels, int input_rate, int output_rate, int quality, int max_samples) {
+    if (channels <= 0 || input_rate <= 0 || output_rate <= 0 || max_samples <= 0)
+        return NULL;
+
+    resampler_t* rs = calloc(1, sizeof(resampler_t));
+    if (!rs) goto fail;
+
+    int gcd = get_gcd(input_rate, output_rate);
+    rs->channels = channels;
+    rs->input_rate = input_rate / gcd;
+    rs->output_rate = output_rate / gcd;
+
+    if (!init_filter(rs, quality))
+        goto fail;
+
+    // enough for a full push after the taps left from previous calls
+    rs->hist_size = max_samples + rs->taps * 2;
+    rs->hist = malloc(rs->hist_size * channels * sizeof(float));
+    if (!rs->hist) goto fail;
+
+    rs->obuf_size = max_samples;
+    rs->obuf = malloc(rs->obuf_size * channels * sizeof(float));
+    if (!rs->obuf) goto fail;
+
+    rs->fmt = SFMT_FLT;
+    resampler_reset(rs, 0);
+
+    return rs;
+fail:
+    resampler_free(rs);
+    return NULL;
+}
+
+void resampler_free(resampler_t* rs) {
+    if (!rs) return;
+
+    free(rs->coefs);
+    free(rs->hist);
+    free(rs->obuf);
+    free(rs);
+}
+
+static void push_silence(resampler_t* rs, int samples) {
+    for (int ch = 0; ch < rs->channels; ch++) {
+        memset(rs->hist + ch * rs->hist_size + rs->hist_end, 0, samples * sizeof(float));
+    }
+    rs->hist_end += samples;
+}
+
+void resampler_reset(resampler_t* rs, int64_t output_sample) {
+    if (!rs) return;
+
+    rs->hist_start = 0;
+    rs->hist_end = 0;
+    rs->frac = (int)((output_sample * rs->input_rate) % rs->output_rate);
+
+    // centers first input sample
+    push_silence(rs, rs->taps / 2 - 1);
+}
+
+// moves pending history to the start to make room for new samples
+static void compact_history(resampler_t* rs) {
+    int pending = rs->hist_end - rs->hist_start;
+    if (rs->hist_start == 0)
+        return;
+
+    for (int ch = 0; ch < rs->channels; ch++) {
+        float* hist = rs->hist + ch * rs->hist_size;
+        memmove(hist, hist + rs->hist_start, pending * sizeof(float));
+    }
+    rs->hist_start = 0;
+    rs->hist_end = pending;
+}
+
+int resampler_get_input_samples(resampler_t* rs, int output_samples) {
+    if (output_samples <= 0)
+        return 0;
+
+    // input needed for the last output sample
+    int64_t last_start = ((int64_t)rs->frac + (int64_t)(output_samples - 1) * rs->input_rate) / rs->output_rate;
+    int64_t needed = rs->hist_start + last_start + rs->taps - rs->hist_end;
+    if (needed < 0)
+        return 0;
+    return (int)needed;
+}
+
+int resampler_get_output_samples(resampler_t* rs) {
+    int64_t max_start = rs->hist_end - rs->taps - rs->hist_start;
+    if (max_start < 0)
+        return 0;
+
+    // outputs N where (frac + N * input_rate) / output_rate <= max_start
+    int64_t limit = (max_start + 1) * rs->output_rate - rs->frac;
+    return (int)((limit + rs->input_rate - 1) / rs->input_rate);
+}
+
+void resampler_push(resampler_t* rs, sbuf_t* ssrc) {
+    int samples = ssrc->filled;
+    if (samples <= 0)
+        return;
+
+    if (rs->hist_end + samples > rs->hist_size)
+        compact_history(rs);
+    if (rs->hist_end + samples > rs->hist_size) {
+        VGM_LOG("RESAMPLER: push too big\n");
+        samples = rs->hist_size - rs->hist_end;
+    }
+
+    // S16 is handled as F16 to keep sample values 1:1 when converting back
+    rs->fmt = (ssrc->fmt == SFMT_S16) ? SFMT_F16 : SFMT_FLT;
+
+    sbuf_t shist;
+    sbuf_init_planar(&shist, rs->fmt, rs->hist + rs->hist_end, samples, rs->channels, rs->hist_size);
+    sbuf_copy_segments(&shist, ssrc, samples);
+
+    rs->hist_end += samples;
+}
+
+void resampler_flush(resampler_t* rs) {
+    if (rs->hist_end + rs->taps > rs->hist_size)
+        compact_history(rs);
+
+    // lookahead for the last input samples
+    push_silence(rs, rs->taps);
+}
+
+static inline float convolve(const float* hist, const float* coefs0, const float* coefs1, float phase_pos, int taps) {
+    float acc[4] = {0};
+
+    for (int i = 0; i < taps; i += 4) {
+        for (int j = 0; j < 4; j++) {
+            float coef = coefs0[i + j] + (coefs1[i + j] - coefs0[i + j]) * phase_pos;
+            acc[j] += hist[i + j] * coef;
+        }
+    }
+
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+static int resample(resampler_t* rs, int samples) {
+    int max = resampler_get_output_samples(rs);
+    if (samples > max)
+        samples = max;
+
+    for (int s = 0; s < samples; s++) {
+        // position between phases
+        int64_t phase_fixed = (int64_t)rs->frac * RESAMPLER_PHASES;
+        int phase = (int)(phase_fixed / rs->output_rate);
+        float phase_pos = (float)(phase_fixed % rs->output_rate) / rs->output_rate;
+
+        const float* coefs0 = &rs->coefs[phase * rs->taps];
+        const float* coefs1 = coefs0 + rs->taps;
+
+        for (int ch = 0; ch < rs->channels; ch++) {
+            const float* hist = rs->hist + ch * rs->hist_size + rs->hist_start;
+            rs->obuf[ch * rs->obuf_size + s] = convolve(hist, coefs0, coefs1, phase_pos, rs->taps);
+        }
+
+        rs->frac += rs->input_rate;
+        rs->hist_start += rs->frac / rs->output_rate;
+        rs->frac %= rs->output_rate;
+    }
+
+    return samples;
+}
+
+int resampler_pull(resampler_t* rs, sbuf_t* sdst, int samples) {
+    int done = 0;
+
+    while (done < samples) {
+        int to_do = samples - done;
+        if (to_do > rs->obuf_size)
+            to_do = rs->obuf_size;
+
+        to_do = resample(rs, to_do);
+        if (to_do <= 0)
+            break;
+
+        sbuf_t sout;
+        sbuf_init_planar(&sout, rs->fmt, rs->obuf, to_do, rs->channels, rs->obuf_size);
+        sout.filled = to_do;
+        sbuf_copy_segments(sdst, &sout, to_do);
+
+        done += to_do;
+    }
+
+    return done;
+}
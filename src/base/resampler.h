@@ -0,0 +1,27 @@
+#ifndef _RESAMPLER_H_
+#define _RESAMPLER_H_
+
+#include "../streamtypes.h"
+#include "sbuf.h"
+
+typedef struct resampler_t resampler_t;
+
+/* Converts rendered samples from one sample rate to another (polyphase windowed sinc).
+ * Samples are pushed in (any fmt, up to max_samples per push) then pulled out in the same fmt and channels. */
+resampler_t* resampler_init(int channels, int input_rate, int output_rate, int quality, int max_samples);
+void resampler_free(resampler_t* rs);
+
+/* clears history for a new position (as output samples, to keep fractional position in sync) */
+void resampler_reset(resampler_t* rs, int64_t output_sample);
+
+/* input samples needed to be able to pull N output samples */
+int resampler_get_input_samples(resampler_t* rs, int output_samples);
+/* output samples that can be pulled right now */
+int resampler_get_output_samples(resampler_t* rs);
+
+void resampler_push(resampler_t* rs, sbuf_t* ssrc);
+/* pushes silence after last input so remaining output samples can be pulled */
+void resampler_flush(resampler_t* rs);
+int resampler_pull(resampler_t* rs, sbuf_t* sdst, int samples);
+
+#endif
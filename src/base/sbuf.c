@@ -145,6 +145,12 @@ void sbuf_init_flt(sbuf_t* sbuf, float* buf, int samples, int channels) {
     sbuf_init(sbuf, SFMT_FLT, buf, samples, channels);
 }
 
+void sbuf_init_planar(sbuf_t* sbuf, sfmt_t format, void* buf, int samples, int channels, int plane_size) {
+    sbuf_init(sbuf, format, buf, samples, channels);
+    sbuf->planar = true;
+    sbuf->plane_size = plane_size;
+}
+
 
 int sfmt_get_sample_size(sfmt_t fmt) {
     switch(fmt) {
@@ -166,8 +172,11 @@ int sfmt_get_sample_size(sfmt_t fmt) {
 void* sbuf_get_filled_buf(sbuf_t* sbuf) {
     int sample_size = sfmt_get_sample_size(sbuf->fmt);
 
+    // planar: first channel's position (others are plane_size apart)
+    int step = sbuf->planar ? 1 : sbuf->channels;
+
     uint8_t* buf = sbuf->buf;
-    buf += sbuf->filled * sbuf->channels * sample_size;
+    buf += sbuf->filled * step * sample_size;
     return buf;
 }
 
@@ -180,8 +189,11 @@ void sbuf_consume(sbuf_t* sbuf, int samples) {
     if (samples > sbuf->samples || samples > sbuf->filled) //???
         return;
 
+    // planar: moves all channels at once since they are plane_size apart from the first
+    int step = sbuf->planar ? 1 : sbuf->channels;
+
     uint8_t* buf = sbuf->buf;
-    buf += samples * sbuf->channels * sample_size;
+    buf += samples * step * sample_size;
 
     sbuf->buf = buf;
     sbuf->filled -= samples;
@@ -201,6 +213,15 @@ int sbuf_get_copy_max(sbuf_t* sdst, sbuf_t* ssrc) {
 void sbuf_silence_part(sbuf_t* sbuf, int from, int count) {
     int sample_size = sfmt_get_sample_size(sbuf->fmt);
 
+    if (sbuf->planar) {
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            uint8_t* buf = sbuf->buf;
+            buf += (ch * sbuf->plane_size + from) * sample_size;
+            memset(buf, 0, count * sample_size);
+        }
+        return;
+    }
+
     uint8_t* buf = sbuf->buf;
     buf += from * sbuf->channels * sample_size;
     memset(buf, 0, count * sbuf->channels * sample_size);
@@ -282,6 +303,133 @@ static sbuf_copy_t copy_matrix[SFMT_MAX][SFMT_MAX] = {
 };
 
 
+
+typedef void (*sbuf_step_t)(void* vsrc, void* vdst, int src_pos, int dst_pos, int src_step, int dst_step, int count);
+
+// Same as above but copies a single channel, for planar bufs (each pos moves by step)
+#define DEFINE_SBUF_STEP(suffix, srctype, dsttype, func) \
+    static void sbuf_step_##suffix(void* vsrc, void* vdst, int src_pos, int dst_pos, int src_step, int dst_step, int count) { \
+        srctype* src = vsrc; \
+        dsttype* dst = vdst; \
+        for (int s = 0; s < count; s++) { \
+            dst[dst_pos] = func(src[src_pos]); \
+            src_pos += src_step; \
+            dst_pos += dst_step; \
+        } \
+    }
+
+#define DEFINE_SBUF_ST24(suffix, srctype, dsttype, func) \
+    static void sbuf_step_##suffix(void* vsrc, void* vdst, int src_pos, int dst_pos, int src_step, int dst_step, int count) { \
+        srctype* src = vsrc; \
+        dsttype* dst = vdst; \
+        for (int s = 0; s < count; s++) { \
+            put_u24ne(dst + dst_pos * 3, func(src[src_pos]) ); \
+            src_pos += src_step; \
+            dst_pos += dst_step; \
+        } \
+    }
+
+DEFINE_SBUF_STEP(s16_s16, int16_t, int16_t, CONV_NOOP);
+DEFINE_SBUF_STEP(s16_f16, int16_t, float,   CONV_NOOP);
+DEFINE_SBUF_STEP(s16_flt, int16_t, float,   CONV_S16_FLT);
+DEFINE_SBUF_STEP(s16_s24, int16_t, int32_t, CONV_S16_S24);
+DEFINE_SBUF_STEP(s16_s32, int16_t, int32_t, CONV_S16_S32);
+DEFINE_SBUF_ST24(s16_o24, int16_t, uint8_t, CONV_S16_S24);
+
+DEFINE_SBUF_STEP(f16_s16, float,   int16_t, CONV_F16_S16);
+DEFINE_SBUF_STEP(f16_f16, float,   float,   CONV_NOOP);
+DEFINE_SBUF_STEP(f16_flt, float,   float,   CONV_F16_FLT);
+DEFINE_SBUF_STEP(f16_s24, float,   int32_t, CONV_F16_S24);
+DEFINE_SBUF_STEP(f16_s32, float,   int32_t, CONV_F16_S32);
+DEFINE_SBUF_ST24(f16_o24, float,   uint8_t, CONV_F16_S24);
+
+DEFINE_SBUF_STEP(flt_s16, float,   int16_t, CONV_FLT_S16);
+DEFINE_SBUF_STEP(flt_f16, float,   float,   CONV_FLT_F16);
+DEFINE_SBUF_STEP(flt_flt, float,   float,   CONV_NOOP);
+DEFINE_SBUF_STEP(flt_s24, float,   int32_t, CONV_FLT_S24);
+DEFINE_SBUF_STEP(flt_s32, float,   int32_t, CONV_FLT_S32);
+DEFINE_SBUF_ST24(flt_o24, float,   uint8_t, CONV_FLT_S24);
+
+DEFINE_SBUF_STEP(s24_s16, int32_t, int16_t, CONV_S24_S16);
+DEFINE_SBUF_STEP(s24_f16, int32_t, float,   CONV_S24_F16);
+DEFINE_SBUF_STEP(s24_flt, int32_t, float,   CONV_S24_FLT);
+DEFINE_SBUF_STEP(s24_s24, int32_t, int32_t, CONV_NOOP);
+DEFINE_SBUF_STEP(s24_s32, int32_t, int32_t, CONV_S24_S32);
+DEFINE_SBUF_ST24(s24_o24, int32_t, uint8_t, CONV_NOOP);
+
+DEFINE_SBUF_STEP(s32_s16, int32_t, int16_t, CONV_S32_S16);
+DEFINE_SBUF_STEP(s32_f16, int32_t, float,   CONV_S32_F16);
+DEFINE_SBUF_STEP(s32_flt, int32_t, float,   CONV_S32_FLT);
+DEFINE_SBUF_STEP(s32_s24, int32_t, int32_t, CONV_S32_S24);
+DEFINE_SBUF_STEP(s32_s32, int32_t, int32_t, CONV_NOOP);
+DEFINE_SBUF_ST24(s32_o24, int32_t, uint8_t, CONV_S32_S24);
+
+// O24 is output only, but may need to be converted to planar or processed after mixing
+#define DEFINE_SBUF_SO24(suffix, dsttype, func) \
+    static void sbuf_step_##suffix(void* vsrc, void* vdst, int src_pos, int dst_pos, int src_step, int dst_step, int count) { \
+        uint8_t* src = vsrc; \
+        dsttype* dst = vdst; \
+        for (int s = 0; s < count; s++) { \
+            int32_t v = get_s24ne(src + src_pos * 3); \
+            dst[dst_pos] = func(v); \
+            src_pos += src_step; \
+            dst_pos += dst_step; \
+        } \
+    }
+
+DEFINE_SBUF_SO24(o24_s16, int16_t, CONV_S24_S16);
+DEFINE_SBUF_SO24(o24_f16, float,   CONV_S24_F16);
+DEFINE_SBUF_SO24(o24_flt, float,   CONV_S24_FLT);
+DEFINE_SBUF_SO24(o24_s24, int32_t, CONV_NOOP);
+DEFINE_SBUF_SO24(o24_s32, int32_t, CONV_S24_S32);
+
+static void sbuf_step_o24_o24(void* vsrc, void* vdst, int src_pos, int dst_pos, int src_step, int dst_step, int count) {
+    uint8_t* src = vsrc;
+    uint8_t* dst = vdst;
+    for (int s = 0; s < count; s++) {
+        memcpy(dst + dst_pos * 3, src + src_pos * 3, 3);
+        src_pos += src_step;
+        dst_pos += dst_step;
+    }
+}
+
+static sbuf_step_t step_matrix[SFMT_MAX][SFMT_MAX] = {
+    { NULL, NULL, NULL, NULL, NULL }, //NONE
+    { NULL, sbuf_step_s16_s16, sbuf_step_s16_f16, sbuf_step_s16_flt, sbuf_step_s16_s24, sbuf_step_s16_s32, sbuf_step_s16_o24 },
+    { NULL, sbuf_step_f16_s16, sbuf_step_f16_f16, sbuf_step_f16_flt, sbuf_step_f16_s24, sbuf_step_f16_s32, sbuf_step_f16_o24 },
+    { NULL, sbuf_step_flt_s16, sbuf_step_flt_f16, sbuf_step_flt_flt, sbuf_step_flt_s24, sbuf_step_flt_s32, sbuf_step_flt_o24 },
+    { NULL, sbuf_step_s24_s16, sbuf_step_s24_f16, sbuf_step_s24_flt, sbuf_step_s24_s24, sbuf_step_s24_s32, sbuf_step_s24_o24 },
+    { NULL, sbuf_step_s32_s16, sbuf_step_s32_f16, sbuf_step_s32_flt, sbuf_step_s32_s24, sbuf_step_s32_s32, sbuf_step_s32_o24 },
+    { NULL, sbuf_step_o24_s16, sbuf_step_o24_f16, sbuf_step_o24_flt, sbuf_step_o24_s24, sbuf_step_o24_s32, sbuf_step_o24_o24 },
+};
+
+// position of sample N in channel C and distance to next sample, for both planar and interleaved bufs
+static inline int get_channel_pos(sbuf_t* sbuf, int sample, int ch) {
+    return sbuf->planar ? ch * sbuf->plane_size + sample : sample * sbuf->channels + ch;
+}
+
+static inline int get_channel_step(sbuf_t* sbuf) {
+    return sbuf->planar ? 1 : sbuf->channels;
+}
+
+// copy N samples of src channels into dst channels (starting from dst_ch_start) when either buf is planar
+static void copy_channels(sbuf_t* sdst, sbuf_t* ssrc, int dst_ch_start, int samples) {
+    sbuf_step_t sbuf_step_src_dst = step_matrix[ssrc->fmt][sdst->fmt];
+    if (!sbuf_step_src_dst) {
+        VGM_LOG("SBUF: undefined step function sfmt %i to %i\n", ssrc->fmt, sdst->fmt);
+        return;
+    }
+
+    int src_step = get_channel_step(ssrc);
+    int dst_step = get_channel_step(sdst);
+    for (int ch = 0; ch < ssrc->channels; ch++) {
+        int src_pos = get_channel_pos(ssrc, 0, ch);
+        int dst_pos = get_channel_pos(sdst, sdst->filled, dst_ch_start + ch);
+
+        sbuf_step_src_dst(ssrc->buf, sdst->buf, src_pos, dst_pos, src_step, dst_step, samples);
+    }
+}
+
 // copy N samples from ssrc into dst (should be clamped externally)
 //TODO: may want to handle sdst->flled + samples externally?
 void sbuf_copy_segments(sbuf_t* sdst, sbuf_t* ssrc, int samples) {
@@ -305,6 +453,13 @@ void sbuf_copy_segments(sbuf_t* sdst, sbuf_t* ssrc, int samples) {
         return;
     }
 
+    // planar <> interleaved (or planar <> planar) is done per channel
+    if (ssrc->planar || sdst->planar) {
+        copy_channels(sdst, ssrc, 0, samples);
+        sdst->filled += samples;
+        return;
+    }
+
     sbuf_copy_t sbuf_copy_src_dst = copy_matrix[ssrc->fmt][sdst->fmt];
     if (!sbuf_copy_src_dst) {
         VGM_LOG("SBUF: undefined copy function sfmt %i to %i\n", ssrc->fmt, sdst->fmt);
@@ -427,6 +582,21 @@ void sbuf_copy_layers(sbuf_t* sdst, sbuf_t* ssrc, int dst_ch_start, int dst_max)
         return;
     }
 
+    if (ssrc->planar || sdst->planar) {
+        copy_channels(sdst, ssrc, dst_ch_start, src_copy);
+
+        // 0-fill rest of this layer's channels
+        int sample_size = sfmt_get_sample_size(sdst->fmt);
+        for (int s = src_copy; s < dst_max; s++) {
+            for (int ch = 0; ch < ssrc->channels; ch++) {
+                uint8_t* buf = sdst->buf;
+                buf += get_channel_pos(sdst, sdst->filled + s, dst_ch_start + ch) * sample_size;
+                memset(buf, 0, sample_size);
+            }
+        }
+        return;
+    }
+
     sbuf_layer_t sbuf_layer_src_dst = layer_matrix[ssrc->fmt][sdst->fmt];
     if (!sbuf_layer_src_dst) {
         VGM_LOG("SBUF: undefined layer function sfmt %i to %i\n", ssrc->fmt, sdst->fmt);
@@ -474,10 +644,7 @@ DEFINE_SBUF_FADE(i32, int32_t);
 DEFINE_SBUF_FADE(flt, float);
 DEFINE_SBUF_FD24(o24, uint8_t);
 
-void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
-    //TODO: use interpolated fadedness to improve performance?
-    //TODO: use float fadedness?
-
+static void fadeout_channels(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
     switch(sbuf->fmt) {
         case SFMT_S16:
             sbuf_fade_i16(sbuf, start, to_do, fade_pos, fade_duration);
@@ -497,6 +664,26 @@ void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_dur
             VGM_LOG("SBUF: missing fade for fmt=%i\n", sbuf->fmt);
             break;
     }
+}
+
+void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration) {
+    //TODO: use interpolated fadedness to improve performance?
+    //TODO: use float fadedness?
+
+    if (sbuf->planar) {
+        // fade each plane as a mono buf
+        int sample_size = sfmt_get_sample_size(sbuf->fmt);
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            sbuf_t splane = *sbuf;
+            splane.buf = ((uint8_t*)sbuf->buf) + ch * sbuf->plane_size * sample_size;
+            splane.channels = 1;
+            splane.planar = false;
+            fadeout_channels(&splane, start, to_do, fade_pos, fade_duration);
+        }
+    }
+    else {
+        fadeout_channels(sbuf, start, to_do, fade_pos, fade_duration);
+    }
 
     /* next samples after fade end would be pad end/silence */
     int count = sbuf->filled - (start + to_do);
@@ -507,6 +694,14 @@ void sbuf_interleave(sbuf_t* sbuf, float** ibuf) {
     if (sbuf->fmt != SFMT_FLT)
         return;
 
+    if (sbuf->planar) {
+        for (int ch = 0; ch < sbuf->channels; ch++) {
+            float* ptr = sbuf->buf;
+            memcpy(ptr + ch * sbuf->plane_size, ibuf[ch], sbuf->filled * sizeof(float));
+        }
+        return;
+    }
+
     // copy multidimensional buf (pcm[0]=[ch0,ch0,...], pcm[1]=[ch1,ch1,...])
     // to interleaved buf (buf[0]=ch0, sbuf[1]=ch1, sbuf[2]=ch0, sbuf[3]=ch1, ...)
     for (int ch = 0; ch < sbuf->channels; ch++) {
@@ -549,6 +744,15 @@ void sbuf_interleave_vorbis(sbuf_t* sbuf, float** src) {
         return;
     int channels = sbuf->channels;
 
+    if (sbuf->planar) {
+        for (int ch = 0; ch < channels; ch++) {
+            int ch_map = (channels > 8) ? ch : xiph_channel_map[channels - 1][ch];
+            float* ptr = sbuf->buf;
+            memcpy(ptr + ch * sbuf->plane_size, src[ch_map], sbuf->filled * sizeof(float));
+        }
+        return;
+    }
+
     /* convert float PCM (multichannel float array, with pcm[0]=ch0, pcm[1]=ch1, pcm[2]=ch0, etc)
      * to 16 bit signed PCM ints (host order) and interleave + fix clipping */
     for (int ch = 0; ch < channels; ch++) {
@@ -3,8 +3,10 @@
 
 #include "../streamtypes.h"
 
-/* All types are interleaved (buffer for all channels = [ch*s] = ch1 ch2 ch1 ch2 ch1 ch2 ...)
- * rather than planar (buffer per channel = [ch][s] = c1 c1 c1 c1 ...  c2 c2 c2 c2 ...) */
+/* All types are interleaved by default (buffer for all channels = [ch*s] = ch1 ch2 ch1 ch2 ch1 ch2 ...)
+ * but may be set as planar (buffer per channel = [ch][s] = c1 c1 c1 c1 ...  c2 c2 c2 c2 ...), in a single
+ * buf where each channel starts 'plane_size' samples apart. Planar bufs are meant for decoders that output
+ * that way and for external output, so only copy/silence/fade helpers handle them. */
 typedef enum {
     SFMT_NONE,
     SFMT_S16,           // PCM16
@@ -27,6 +29,9 @@ typedef struct {
     int channels;       // interleaved step or planar buffers
     int samples;        // max samples
     int filled;         // samples in buffer
+
+    bool planar;        // channels aren't interleaved
+    int plane_size;     // samples between channels when planar (usually the original max samples)
 } sbuf_t;
 
 /* it's probably slightly faster to make some function inline'd, but aren't called that often to matter (given big enough total samples) */
@@ -35,6 +40,7 @@ void sbuf_init(sbuf_t* sbuf, sfmt_t format, void* buf, int samples, int channels
 void sbuf_init_s16(sbuf_t* sbuf, int16_t* buf, int samples, int channels);
 void sbuf_init_f16(sbuf_t* sbuf, float* buf, int samples, int channels);
 void sbuf_init_flt(sbuf_t* sbuf, float* buf, int samples, int channels);
+void sbuf_init_planar(sbuf_t* sbuf, sfmt_t format, void* buf, int samples, int channels, int plane_size);
 
 int sfmt_get_sample_size(sfmt_t fmt);
 
@@ -54,6 +60,7 @@ void sbuf_silence_part(sbuf_t* sbuf, int from, int count);
 
 void sbuf_fadeout(sbuf_t* sbuf, int start, int to_do, int fade_pos, int fade_duration);
 
+/* copy multidimensional float bufs to sbuf (interleaving, or as-is if sbuf is planar) */
 void sbuf_interleave(sbuf_t* sbuf, float** ibuf);
 void sbuf_interleave_vorbis(sbuf_t* sbuf, float** ibuf);
 
@@ -18,13 +18,42 @@ static void seek_force_loop_end(VGMSTREAM* vgmstream, int loop_count) {
     decode_do_loop(vgmstream);
 }
 
+/* garbage buffer for seeking/discarding (local bufs may cause stack overflows with segments/layers)
+ * in theory the bigger the better but in practice there isn't much difference. */
+static bool prepare_tmpbuf(VGMSTREAM* vgmstream) {
+    if (vgmstream->tmpbuf)
+        return true;
+
+    vgmstream->tmpbuf_size = 1024 * 2 * vgmstream->channels * sizeof(float);
+    vgmstream->tmpbuf = malloc(vgmstream->tmpbuf_size);
+    if (!vgmstream->tmpbuf)
+        return false;
+
+    /* created after setup_vgmstream, reset would restore a NULL buf otherwise */
+    ((VGMSTREAM*)vgmstream->start_vgmstream)->tmpbuf = vgmstream->tmpbuf;
+    ((VGMSTREAM*)vgmstream->start_vgmstream)->tmpbuf_size = vgmstream->tmpbuf_size;
+    return true;
+}
+
 static void seek_force_decode(VGMSTREAM* vgmstream, int samples) {
+    if (!prepare_tmpbuf(vgmstream)) {
+        VGM_LOG("SEEK: can't allocate tmpbuf\n");
+        return;
+    }
+
     void* tmpbuf = vgmstream->tmpbuf;
     int buf_samples = vgmstream->tmpbuf_size / vgmstream->channels / sizeof(float); /* base decoder channels, no need to apply mixing */
 
     sbuf_t sbuf_tmp;
     sbuf_init(&sbuf_tmp, mixing_get_input_sample_type(vgmstream), tmpbuf, buf_samples, vgmstream->channels);
 
+    /* blocked layouts may be able to jump near the target first (no effect in other layouts) */
+    if (samples > 0) {
+        int32_t seek_sample = vgmstream->current_sample + samples;
+        seek_layout_blocked(vgmstream, seek_sample);
+        samples = seek_sample - vgmstream->current_sample;
+    }
+
     while (samples) {
         int to_do = samples;
         if (to_do > buf_samples)
@@ -14,8 +14,14 @@ void adx_next_key(VGMSTREAMCHANNEL* stream);
 
 
 /* g721_decoder */
-void decode_g721(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
-void g72x_init_state(struct g72x_state* state_ptr);
+typedef struct g721_codec_data g721_codec_data;
+
+g721_codec_data* init_g721(int channels);
+void decode_g721(VGMSTREAMCHANNEL* stream, g721_codec_data* data, int channel, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do);
+void reset_g721(g721_codec_data* data);
+void loop_g721(g721_codec_data* data);
+void seek_g721(g721_codec_data* data);
+void free_g721(g721_codec_data* data);
 
 
 /* ima_decoder */
@@ -78,7 +84,7 @@ void decode_ngc_afc(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspaci
 /* vadpcm_decoder */
 void decode_vadpcm(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int order);
 //int32_t vadpcm_bytes_to_samples(size_t bytes, int channels);
-void vadpcm_read_coefs_be(VGMSTREAM* vgmstream, STREAMFILE* sf, off_t offset, int order, int entries, int ch);
+bool vadpcm_read_coefs_be(VGMSTREAM* vgmstream, STREAMFILE* sf, off_t offset, int order, int entries, int ch);
 
 
 /* pcm_decoder */
@@ -6,6 +6,15 @@
 #include <libavformat/avformat.h>
 #include <libswresample/swresample.h>
 
+#define FFMPEG_INDEX_INTERVAL 4096  /* min samples between packet index entries */
+#define FFMPEG_INDEX_PREROLL  2048  /* frame samples when codec doesn't report frame_size */
+
+/* demuxed packet position */
+typedef struct {
+    int64_t pos;                /* offset as seen by FFmpeg */
+    int64_t ts;                 /* in stream's time_base */
+} ffmpeg_index_t;
+
 /* opaque struct */
 struct ffmpeg_codec_data {
     /*** IO internals ***/
@@ -19,6 +28,7 @@ struct ffmpeg_codec_data {
 
     uint64_t header_size;       // fake header (parseable by FFmpeg) prepended on reads
     uint8_t* header_block;      // fake header data (ie. RIFF)
+    int io_buffer_size;         // AVIO buffer (also used for the internal streamfile)
 
     /*** internal state ***/
     // config
@@ -52,10 +62,21 @@ struct ffmpeg_codec_data {
     int32_t samples_discard;
     int32_t samples_consumed;
     int32_t samples_filled;
+
+    /* packet index, built as packets are demuxed so seeks/loops can start near target */
+    ffmpeg_index_t* index;
+    int index_count;
+    int index_size;
+    int index_enabled;
+    int index_recording;        /* only when decoding from start, as timestamps after byte seeks may be unreliable */
+    int index_base_set;
+    int64_t index_base_ts;      /* timestamp of first output sample (after FFmpeg's internal skips) */
 };
 
 
 #define FFMPEG_DEFAULT_IO_BUFFER_SIZE  STREAMFILE_DEFAULT_BUFFER_SIZE
+#define FFMPEG_MIN_IO_BUFFER_SIZE      0x1000
+#define FFMPEG_MAX_IO_BUFFER_SIZE      0x100000
 
 static volatile int g_ffmpeg_initialized = 0;
 
@@ -294,6 +315,18 @@ static int64_t ffmpeg_seek(void* opaque, int64_t offset, int whence) {
 /* MAIN INIT/DECODER                            */
 /* ******************************************** */
 
+/* optionally set by the caller through the streamfile (per open, like stream_index) */
+static int get_io_buffer_size(STREAMFILE* sf) {
+    int io_buffer_size = sf->io_buffer_size;
+    if (io_buffer_size <= 0)
+        return FFMPEG_DEFAULT_IO_BUFFER_SIZE;
+    if (io_buffer_size < FFMPEG_MIN_IO_BUFFER_SIZE)
+        return FFMPEG_MIN_IO_BUFFER_SIZE;
+    if (io_buffer_size > FFMPEG_MAX_IO_BUFFER_SIZE)
+        return FFMPEG_MAX_IO_BUFFER_SIZE;
+    return io_buffer_size;
+}
+
 ffmpeg_codec_data* init_ffmpeg_offset(STREAMFILE* sf, uint64_t start, uint64_t size) {
     return init_ffmpeg_header_offset(sf, NULL,0, start,size);
 }
@@ -335,7 +368,9 @@ ffmpeg_codec_data* init_ffmpeg_header_offset_subsong(STREAMFILE* sf, uint8_t* he
     data = calloc(1, sizeof(ffmpeg_codec_data));
     if (!data) return NULL;
 
-    data->sf = reopen_streamfile(sf, 0);
+    data->io_buffer_size = get_io_buffer_size(sf);
+
+    data->sf = reopen_streamfile(sf, data->io_buffer_size);
     if (!data->sf) goto fail;
 
     /* fake header to trick FFmpeg into demuxing/decoding the stream */
@@ -423,6 +458,11 @@ ffmpeg_codec_data* init_ffmpeg_header_offset_subsong(STREAMFILE* sf, uint8_t* he
         VGM_LOG("FFMPEG: can't init_seek, error=%i (using force_seek)\n", errcode);
         ffmpeg_set_force_seek(data);
     }
+    else if (strcmp(data->formatCtx->iformat->name, "ogg") != 0) {
+        /* Ogg demuxer keeps page state that isn't reset on byte seeks */
+        data->index_enabled = 1;
+        data->index_recording = 1;
+    }
 
     return data;
 fail:
@@ -460,10 +500,10 @@ static int init_ffmpeg_config(ffmpeg_codec_data* data, int target_subsong, int r
     int errcode = 0;
 
     /* custom IO/format setup */
-    data->buffer = av_malloc(FFMPEG_DEFAULT_IO_BUFFER_SIZE);
+    data->buffer = av_malloc(data->io_buffer_size);
     if (!data->buffer) goto fail;
 
-    data->ioCtx = avio_alloc_context(data->buffer, FFMPEG_DEFAULT_IO_BUFFER_SIZE, 0, data, ffmpeg_read, 0, ffmpeg_seek);
+    data->ioCtx = avio_alloc_context(data->buffer, data->io_buffer_size, 0, data, ffmpeg_read, 0, ffmpeg_seek);
     if (!data->ioCtx) goto fail;
 
     data->formatCtx = avformat_alloc_context();
@@ -545,6 +585,114 @@ fail:
     return -1;
 }
 
+/* adds packet to index if far enough from last entry */
+static void index_add_packet(ffmpeg_codec_data* data, AVPacket* pkt) {
+    if (!data->index_recording || pkt->pos < 0)
+        return;
+
+    int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    if (ts == AV_NOPTS_VALUE)
+        return;
+
+    if (data->index_count > 0) {
+        AVStream* stream = data->formatCtx->streams[data->stream_index];
+        AVRational tb = {1, data->codecCtx->sample_rate};
+        ffmpeg_index_t* last = &data->index[data->index_count - 1];
+
+        /* already indexed (decoding again after a reset) */
+        if (pkt->pos <= last->pos || ts <= last->ts)
+            return;
+        if (av_rescale_q(ts - last->ts, stream->time_base, tb) < FFMPEG_INDEX_INTERVAL)
+            return;
+    }
+
+    if (data->index_count >= data->index_size) {
+        int index_size = data->index_size ? data->index_size * 2 : 256;
+        ffmpeg_index_t* index = realloc(data->index, index_size * sizeof(ffmpeg_index_t));
+        if (!index) {
+            data->index_recording = 0;
+            return;
+        }
+        data->index = index;
+        data->index_size = index_size;
+    }
+
+    data->index[data->index_count].pos = pkt->pos;
+    data->index[data->index_count].ts = ts;
+    data->index_count++;
+}
+
+/* first output frame's pts marks sample 0, so packet timestamps can be converted to output samples */
+static void index_set_base(ffmpeg_codec_data* data, AVFrame* frame) {
+    if (!data->index_recording || data->index_base_set || frame->nb_samples <= 0)
+        return;
+
+    if (frame->pts == AV_NOPTS_VALUE) {
+        data->index_enabled = 0;
+        data->index_recording = 0;
+        return;
+    }
+
+    data->index_base_ts = frame->pts;
+    data->index_base_set = 1;
+}
+
+/* seeks to the last indexed packet before sample (minus codec pre-roll), returning its sample (0 = not possible) */
+static int64_t index_seek(ffmpeg_codec_data* data, int64_t sample) {
+    if (!data->index_enabled || !data->index_base_set || data->index_count <= 1 || data->codecCtx->sample_rate <= 0)
+        return 0;
+
+    AVStream* stream = data->formatCtx->streams[data->stream_index];
+    AVRational tb = {1, data->codecCtx->sample_rate};
+
+    /* some codecs need a few frames to settle (MDCT overlap, Opus' pre-roll) */
+    int frame_size = data->codecCtx->frame_size > 0 ? data->codecCtx->frame_size : FFMPEG_INDEX_PREROLL;
+    int64_t preroll = stream->codecpar->seek_preroll + frame_size * 2;
+    if (sample - preroll <= 0)
+        return 0;
+    int64_t max_ts = data->index_base_ts + av_rescale_q(sample - preroll, tb, stream->time_base);
+
+    int lo = 0, hi = data->index_count - 1, pos = -1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (data->index[mid].ts <= max_ts) {
+            pos = mid;
+            lo = mid + 1;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+    if (pos <= 0) /* start, regular seek is fine */
+        return 0;
+
+    ffmpeg_index_t* entry = &data->index[pos];
+    int64_t entry_sample = av_rescale_q(entry->ts - data->index_base_ts, stream->time_base, tb);
+    if (entry_sample <= 0)
+        return 0;
+
+    if (av_seek_frame(data->formatCtx, data->stream_index, entry->pos, AVSEEK_FLAG_BYTE) < 0)
+        return 0;
+
+    /* make sure demuxer resyncs at the expected packet, then send it so decoding continues from there */
+    AVPacket* pkt = data->packet;
+    while (1) {
+        av_packet_unref(pkt);
+        if (av_read_frame(data->formatCtx, pkt) < 0)
+            return 0;
+        if (pkt->stream_index == data->stream_index)
+            break;
+    }
+    if (pkt->pos != entry->pos) {
+        VGM_LOG("FFMPEG: unexpected index packet at %x (expected %x)\n", (uint32_t)pkt->pos, (uint32_t)entry->pos);
+        return 0;
+    }
+
+    if (avcodec_send_packet(data->codecCtx, pkt) < 0)
+        return 0;
+    return entry_sample;
+}
+
 /* decodes a new frame to internal data */
 static int decode_ffmpeg_frame(ffmpeg_codec_data* data) {
     int errcode;
@@ -588,6 +736,9 @@ static int decode_ffmpeg_frame(ffmpeg_codec_data* data) {
             /* ignore non-selected streams */
             if (data->packet->stream_index != data->stream_index)
                 continue;
+
+            if (errcode >= 0)
+                index_add_packet(data, data->packet);
         }
 
         /* send encoded data to frame decoder (NULL at EOF to "drain" samples below) */
@@ -618,6 +769,9 @@ static int decode_ffmpeg_frame(ffmpeg_codec_data* data) {
                 frame_error = 1;//goto fail;
             }
         }
+        else {
+            index_set_base(data, data->frame);
+        }
     }
 
     /* on frame_error simply uses current frame (possibly with nb_samples=0), which mirrors ffmpeg's output
@@ -876,7 +1030,17 @@ void seek_ffmpeg(ffmpeg_codec_data* data, int32_t num_sample) {
     if (!data) return;
 
     /* Start from 0 and discard samples until sample (slower but not too noticeable).
-     * Due to many FFmpeg quirks seeking to a sample is erratic at best in most formats. */
+     * Due to many FFmpeg quirks seeking to a sample is erratic at best in most formats.
+     * Once packets have been demuxed it can start from the closest one instead (byte seek
+     * to a known packet + discard, rather than trusting FFmpeg's timestamp seeking). */
+    int64_t discard_sample = num_sample;
+    int64_t index_sample = 0;
+
+    /* consider skip samples (encoder delay), if manually set */
+    if (data->skip_samples_set) {
+        discard_sample += data->skip_samples;
+        /* internally FFmpeg may skip (skip_samples/start_skip_samples) too */
+    }
 
     if (data->force_seek) {
         int errcode;
@@ -893,24 +1057,24 @@ void seek_ffmpeg(ffmpeg_codec_data* data, int32_t num_sample) {
         if (errcode < 0) goto fail;
     }
     else {
-        avformat_seek_file(data->formatCtx, data->stream_index, 0, 0, 0, AVSEEK_FLAG_ANY);
         avcodec_flush_buffers(data->codecCtx);
+
+        index_sample = index_seek(data, discard_sample);
+        if (!index_sample) {
+            avformat_seek_file(data->formatCtx, data->stream_index, 0, 0, 0, AVSEEK_FLAG_ANY);
+            avcodec_flush_buffers(data->codecCtx);
+        }
+        data->index_recording = data->index_enabled && !index_sample;
     }
 
     data->samples_consumed = 0;
     data->samples_filled = 0;
-    data->samples_discard = num_sample;
+    data->samples_discard = discard_sample - index_sample;
 
-    data->read_packet = 1;
+    data->read_packet = !index_sample; /* index packet was already sent */
     data->end_of_stream = 0;
     data->end_of_audio = 0;
 
-    /* consider skip samples (encoder delay), if manually set */
-    if (data->skip_samples_set) {
-        data->samples_discard += data->skip_samples;
-        /* internally FFmpeg may skip (skip_samples/start_skip_samples) too */
-    }
-
     return;
 fail:
     VGM_LOG("FFMPEG: error during force_seek\n");
@@ -963,6 +1127,7 @@ void free_ffmpeg(ffmpeg_codec_data* data) {
         return;
 
     free_ffmpeg_config(data);
+    free(data->index);
 
     if (data->header_block) {
         av_free(data->header_block);
@@ -1076,6 +1241,8 @@ void ffmpeg_set_force_seek(ffmpeg_codec_data* data) {
      * or MPC with an incorrectly parsed seek table (using as 0 some non-0 seek offset).
      * whatever, we'll just kill and reconstruct FFmpeg's config every time */
     data->force_seek = 1;
+    data->index_enabled = 0;
+    data->index_recording = 0;
     reset_ffmpeg(data); /* reset state from trying to seek */
     //stream = data->formatCtx->streams[data->stream_index];
 }
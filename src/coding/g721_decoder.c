@@ -31,6 +31,14 @@
 
 #include "coding.h"
 #include "../util.h"
+#include "g72x_state.h"
+
+/* decoder state is kept apart from VGMSTREAMCHANNEL as it's big and only used here */
+struct g721_codec_data {
+    int channels;
+    struct g72x_state* state;       /* current state per channel */
+    struct g72x_state* loop_state;  /* saved on loop start */
+};
 
 static short power2[15] = {1, 2, 4, 8, 0x10, 0x20, 0x40, 0x80,
                 0x100, 0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000};
@@ -92,7 +100,7 @@ fmult(
  * pointed to by 'state_ptr'.
  * All the initial state values are specified in the CCITT G.721 document.
  */
-void
+static void
 g72x_init_state(
     struct g72x_state *state_ptr)
 {
@@ -457,15 +465,64 @@ g721_decoder(
     return (sr << 2);    /* sr was 14-bit dynamic range */
 }
 
-void decode_g721(VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+void decode_g721(VGMSTREAMCHANNEL* stream, g721_codec_data* data, int channel, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
     int i;
     int32_t sample_count;
+    struct g72x_state* state = &data->state[channel];
 
     for (i = first_sample, sample_count = 0; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
         outbuf[sample_count]=
             g721_decoder(
             read_8bit(stream->offset+i/2,stream->streamfile)>>(i&1?4:0),
-            &(stream->g72x_state)
+            state
             );
     }
 }
+
+
+g721_codec_data* init_g721(int channels) {
+    g721_codec_data* data = calloc(1, sizeof(g721_codec_data));
+    if (!data) goto fail;
+
+    data->channels = channels;
+    data->state = calloc(channels, sizeof(struct g72x_state));
+    if (!data->state) goto fail;
+    data->loop_state = calloc(channels, sizeof(struct g72x_state));
+    if (!data->loop_state) goto fail;
+
+    reset_g721(data);
+    return data;
+fail:
+    free_g721(data);
+    return NULL;
+}
+
+void reset_g721(g721_codec_data* data) {
+    if (!data) return;
+
+    for (int ch = 0; ch < data->channels; ch++) {
+        g72x_init_state(&data->state[ch]);
+    }
+}
+
+/* save state on loop start, like regular ADPCM's loop_ch */
+void loop_g721(g721_codec_data* data) {
+    if (!data) return;
+
+    memcpy(data->loop_state, data->state, data->channels * sizeof(struct g72x_state));
+}
+
+/* restore state saved on loop start (only used to loop) */
+void seek_g721(g721_codec_data* data) {
+    if (!data) return;
+
+    memcpy(data->state, data->loop_state, data->channels * sizeof(struct g72x_state));
+}
+
+void free_g721(g721_codec_data* data) {
+    if (!data) return;
+
+    free(data->state);
+    free(data->loop_state);
+    free(data);
+}
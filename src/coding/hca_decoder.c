@@ -128,10 +128,10 @@ bool decode_frame_hca(VGMSTREAM* v) {
         return false;
     }
 
-    clHCA_ReadSamples(data->handle, data->fbuf);
+    clHCA_ReadSamplesPlanar(data->handle, data->fbuf);
 
     int samples = data->info.samplesPerBlock;
-    sbuf_init_flt(&ds->sbuf, data->fbuf, samples, v->channels);
+    sbuf_init_planar(&ds->sbuf, SFMT_FLT, data->fbuf, samples, v->channels, samples);
     ds->sbuf.filled = samples;
 
     if (data->current_delay) {
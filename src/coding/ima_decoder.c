@@ -21,6 +21,55 @@ static inline int _clamp_s32(int value, int min, int max) {
         return value;
 }
 
+/* Nibbles are read from the STREAMFILE in chunks, as decoders are called for a frame or part of
+ * an interleave block and read sequentially (mostly), rather than going through the vtable per sample */
+#define IMA_BUF_SIZE 0x200
+
+typedef struct {
+    STREAMFILE* sf;
+    off_t offset;       /* current buffered offset */
+    off_t end;          /* max offset this call will read */
+    int bytes;          /* current buffered bytes */
+    uint8_t data[IMA_BUF_SIZE];
+} ima_buf_t;
+
+static void ima_buf_init(ima_buf_t* buf, STREAMFILE* sf, off_t end) {
+    buf->sf = sf;
+    buf->offset = 0;
+    buf->end = end;
+    buf->bytes = 0;
+}
+
+static void ima_buf_fill(ima_buf_t* buf, off_t offset) {
+    int bytes, read;
+
+    bytes = IMA_BUF_SIZE;
+    if (bytes > buf->end - offset)
+        bytes = buf->end - offset;
+    if (bytes <= 0) /* shouldn't happen */
+        bytes = 1;
+
+    read = read_streamfile(buf->data, offset, bytes, buf->sf);
+    if (read < bytes) /* same as read_u8 past EOF */
+        memset(buf->data + read, 0xFF, bytes - read);
+
+    buf->offset = offset;
+    buf->bytes = bytes;
+}
+
+static inline uint8_t ima_buf_get(ima_buf_t* buf, off_t offset) {
+    if (offset < buf->offset || offset >= buf->offset + buf->bytes)
+        ima_buf_fill(buf, offset);
+    return buf->data[offset - buf->offset];
+}
+
+/* reads a full frame, for decoders with small fixed frames */
+static void ima_read_frame(uint8_t* frame, off_t offset, int frame_size, STREAMFILE* sf) {
+    int read = read_streamfile(frame, offset, frame_size, sf);
+    if (read < frame_size) /* same as read_u8 past EOF */
+        memset(frame + read, 0xFF, frame_size - read);
+}
+
 
 static const int16_t ima_step_size_table[89+1] = {
     7, 8, 9, 10, 11, 12, 13, 14,
@@ -72,16 +121,11 @@ static void std_ima_expand_nibble_data(uint8_t byte, int shift, int32_t* hist1,
     if (*index > 88) *index = 88;
 }
 
-static void std_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
-    uint8_t byte = read_u8(byte_offset,stream->streamfile);
-    std_ima_expand_nibble_data(byte, nibble_shift, hist1, step_index);
-}
-
 /* Apple's IMA variation. Exactly the same except it uses 16b history (probably more sensitive to overflow/sign extend?) */
-static void std_ima_expand_nibble_16(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int16_t * hist1, int32_t * step_index) {
+static void std_ima_expand_nibble_16(uint8_t byte, int nibble_shift, int16_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -100,7 +144,7 @@ static void std_ima_expand_nibble_16(VGMSTREAMCHANNEL * stream, off_t byte_offse
 
 /* Original IMA expansion, but using MULs rather than shift+ADDs (faster for newer processors).
  * There is minor rounding difference between ADD and MUL expansions, noticeable/propagated in non-headered IMAs. */
-static void std_ima_expand_nibble_mul(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void std_ima_expand_nibble_mul(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
     /* simplified through math from:
@@ -109,7 +153,7 @@ static void std_ima_expand_nibble_mul(VGMSTREAMCHANNEL * stream, off_t byte_offs
      *    > diff = (code + 1/2) * 2 * step / 8
      * final diff = [signed] ((code * 2 + 1) * step) / 8 */
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -125,10 +169,10 @@ static void std_ima_expand_nibble_mul(VGMSTREAMCHANNEL * stream, off_t byte_offs
 }
 
 /* Camelot IMA (Mario Golf, Mario Tennis; maybe other Camelot games) */
-static void camelot_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void camelot_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -146,10 +190,10 @@ static void camelot_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offs
 }
 
 /* The Incredibles PC, updates step_index before doing current sample */
-static void snds_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void snds_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
 
     *step_index += ima_index_table[sample_nibble];
@@ -166,10 +210,10 @@ static void snds_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset,
 }
 
 /* Omikron: The Nomad Soul, algorithm from the .exe */
-static void otns_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void otns_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -188,10 +232,10 @@ static void otns_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset,
 }
 
 /* Fairly OddParents (PC) .WV6: minor variation, reverse engineered from the .exe */
-static void wv6_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void wv6_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -207,10 +251,10 @@ static void wv6_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset,
 }
 
 /* High Voltage variation, reverse engineered from .exes [Lego Racers (PC), NBA Hangtime (PC)] */
-static void hv_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void hv_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf;
+    sample_nibble = (byte >> nibble_shift)&0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -226,10 +270,10 @@ static void hv_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, i
 }
 
 /* FFTA2 IMA, different hist and sample rounding, reverse engineered from the ROM */
-static void ffta2_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index, int16_t *out_sample) {
+static void ffta2_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index, int16_t *out_sample) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf; /* ADPCM code */
+    sample_nibble = (byte >> nibble_shift)&0xf; /* ADPCM code */
     sample_decoded = *hist1; /* predictor value */
     step = ima_step_size_table[*step_index] * 0x100; /* current step (table in ROM is pre-multiplied though) */
 
@@ -255,10 +299,10 @@ static void ffta2_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset
 }
 
 /* Yet another IMA expansion, from the exe */
-static void blitz_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void blitz_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift)&0xf; /* ADPCM code */
+    sample_nibble = (byte >> nibble_shift)&0xf; /* ADPCM code */
     sample_decoded = *hist1; /* predictor value */
     step = ima_step_size_table[*step_index]; /* current step */
 
@@ -285,10 +329,10 @@ static const int CIMAADPCM_INDEX_TABLE[16] = {8,  6,  4,  2,  -1, -1, -1, -1,
                                              -1, -1, -1, -1, 2,  4,  6,  8};
 
 /* Capcom's MT Framework modified IMA, reverse engineered from the exe */
-static void mtf_ima_expand_nibble(VGMSTREAMCHANNEL * stream, off_t byte_offset, int nibble_shift, int32_t * hist1, int32_t * step_index) {
+static void mtf_ima_expand_nibble(uint8_t byte, int nibble_shift, int32_t * hist1, int32_t * step_index) {
     int sample_nibble, sample_decoded, step, delta;
 
-    sample_nibble = (read_8bit(byte_offset,stream->streamfile) >> nibble_shift) & 0xf;
+    sample_nibble = (byte >> nibble_shift) & 0xf;
     sample_decoded = *hist1;
     step = ima_step_size_table[*step_index];
 
@@ -363,6 +407,7 @@ static void cd_ima_expand_nibble(uint8_t byte, int shift, int32_t* hist1, int32_
  * Configurable: stereo or mono/interleave nibbles, and high or low nibble first.
  * For vgmstream, low nibble is called "IMA ADPCM" and high nibble is "DVI IMA ADPCM" (same thing though). */
 void decode_standard_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, int is_stereo, int is_high_first) {
+    ima_buf_t buf;
     int i, sample_count = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -373,6 +418,10 @@ void decode_standard_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
     if (step_index < 0) step_index=0;
     if (step_index > 88) step_index=88;
 
+    ima_buf_init(&buf, stream->streamfile, is_stereo ?
+            stream->offset + first_sample + samples_to_do :
+            stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     /* decode nibbles (layout: varies) */
     for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
         off_t byte_offset = is_stereo ?
@@ -382,7 +431,7 @@ void decode_standard_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
                 is_stereo ? (!(channel&1) ? 4:0) : (!(i&1) ? 4:0) : /* even = high, odd = low */
                 is_stereo ? (!(channel&1) ? 0:4) : (!(i&1) ? 0:4);  /* even = low, odd = high */
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -391,6 +440,7 @@ void decode_standard_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
 }
 
 void decode_mtf_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, int is_stereo) {
+    ima_buf_t buf;
     int i, sample_count = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -401,6 +451,10 @@ void decode_mtf_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
     if (step_index < 0) step_index=0;
     if (step_index > 88) step_index=88;
 
+    ima_buf_init(&buf, stream->streamfile, is_stereo ?
+            stream->offset + first_sample + samples_to_do :
+            stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     /* decode nibbles (layout: varies) */
     for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
         off_t byte_offset = is_stereo ?
@@ -410,7 +464,7 @@ void decode_mtf_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
                 ((channel&1) ? 0:4) :
                 ((i&1) ? 0:4);
 
-        mtf_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        mtf_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = clamp16(hist1 >> 4);
     }
 
@@ -419,6 +473,7 @@ void decode_mtf_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 }
 
 void decode_camelot_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -427,11 +482,13 @@ void decode_camelot_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?4:0); //low nibble order
 
-        camelot_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        camelot_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -440,6 +497,7 @@ void decode_camelot_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
 }
 
 void decode_snds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -448,11 +506,13 @@ void decode_snds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + first_sample + samples_to_do);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i;//one nibble per channel
         int nibble_shift = (channel==0?0:4); //high nibble first, based on channel
 
-        snds_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        snds_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -461,6 +521,7 @@ void decode_snds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 }
 
 void decode_otns_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -469,13 +530,17 @@ void decode_otns_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, vgmstream->channels == 1 ?
+            stream->offset + (first_sample + samples_to_do - 1)/2 + 1 :
+            stream->offset + first_sample + samples_to_do);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + (vgmstream->channels==1 ? i/2 : i); //one nibble per channel if stereo
         int nibble_shift = (vgmstream->channels==1) ? //todo simplify
                     (i&1?0:4) : //high nibble first(?)
                     (channel==0?4:0); //low=ch0, high=ch1 (this is correct compared to vids)
 
-        otns_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        otns_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -485,6 +550,7 @@ void decode_otns_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t
 
 /* WV6 IMA, DVI IMA with custom nibble expand */
 void decode_wv6_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -493,11 +559,13 @@ void decode_wv6_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        wv6_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        wv6_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -507,6 +575,7 @@ void decode_wv6_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
 /* High Voltage's DVI IMA with simplified nibble expand */
 void decode_hv_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -515,11 +584,13 @@ void decode_hv_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspac
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        hv_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        hv_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -529,6 +600,7 @@ void decode_hv_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspac
 
 /* FFTA2 IMA, DVI IMA with custom nibble expand/rounding */
 void decode_sqex_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -538,11 +610,13 @@ void decode_sqex_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        ffta2_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index, &out_sample);
+        ffta2_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index, &out_sample);
         outbuf[sample_count] = out_sample;
     }
 
@@ -552,6 +626,7 @@ void decode_sqex_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
 /* Blitz IMA, IMA with custom nibble expand */
 void decode_blitz_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -560,11 +635,13 @@ void decode_blitz_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channels
 
     //no header
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + i/2;
         int nibble_shift = (i&1?4:0); //low nibble first
 
-        blitz_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        blitz_ima_expand_nibble(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)clamp16(hist1);
     }
 
@@ -580,6 +657,7 @@ void decode_blitz_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channels
  * so to simplify calcs this decodes full frames, thus hist doesn't need to be mantained.
  * Officially defined in "Microsoft Multimedia Standards Update" doc (RIFFNEW.pdf). */
 void decode_ms_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, samples_read = 0, samples_done = 0, max_samples;
     int32_t hist1;// = stream->adpcm_history1_32;
     int step_index;// = stream->adpcm_step_index;
@@ -611,12 +689,14 @@ void decode_ms_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* out
     if (max_samples > samples_to_do + first_sample - samples_done)
         max_samples = samples_to_do + first_sample - samples_done; /* for smaller last block */
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + vgmstream->frame_size);
+
     /* decode nibbles (layout: alternates 4 bytes/4*2 nibbles per channel) */
     for (i = 0; i < max_samples; i++) {
         off_t byte_offset = stream->offset + 0x04*frame_channels + 0x04*frame_channel + 0x04*frame_channels*(i/8) + (i%8)/2;
         int nibble_shift = (i&1?4:0); /* low nibble first */
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index); /* original expand */
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index); /* original expand */
 
         if (samples_read >= first_sample && samples_done < samples_to_do) {
             outbuf[samples_done * channelspacing] = (short)(hist1);
@@ -636,6 +716,7 @@ void decode_ms_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* out
 
 /* Reflection's MS-IMA with custom nibble layout (some info from XA2WAV by Deniz Oezmen) */
 void decode_ref_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, samples_read = 0, samples_done = 0, max_samples;
     int32_t hist1;// = stream->adpcm_history1_32;
     int step_index;// = stream->adpcm_step_index;
@@ -666,12 +747,14 @@ void decode_ref_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
     if (max_samples > samples_to_do + first_sample - samples_done)
         max_samples = samples_to_do + first_sample - samples_done; /* for smaller last block */
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x04*vgmstream->channels + block_channel_size*(channel + 1));
+
     /* decode nibbles (layout: all nibbles from one channel, then other channels) */
     for (i = 0; i < max_samples; i++) {
         off_t byte_offset = stream->offset + 0x04*vgmstream->channels + block_channel_size*channel + i/2;
         int nibble_shift = (i&1?4:0); /* low nibble first */
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
 
         if (samples_read >= first_sample && samples_done < samples_to_do) {
             outbuf[samples_done * channelspacing] = (short)(hist1);
@@ -696,6 +779,7 @@ void decode_ref_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
 /* MS-IMA with fixed frame size, and outputs an even number of samples per frame (skips last nibble).
  * Defined in Xbox's SDK. Usable in mono or stereo modes (both suitable for interleaved multichannel). */
 void decode_xbox_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, int is_stereo) {
+    uint8_t frame[0x24*2];
     int i, frames_in, sample_pos = 0, block_samples, frame_size;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -708,15 +792,16 @@ void decode_xbox_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
     frame_size = is_stereo ? 0x24*2 : 0x24;
 
     frame_offset = stream->offset + frame_size*frames_in;
+    ima_read_frame(frame, frame_offset, frame_size, stream->streamfile);
 
     /* normal header (hist+step+reserved), stereo/mono */
     if (first_sample == 0) {
-        off_t header_offset = is_stereo ?
-                frame_offset + 0x04*(channel % 2) :
-                frame_offset + 0x00;
+        int header_pos = is_stereo ?
+                0x04*(channel % 2) :
+                0x00;
 
-        hist1   = read_16bitLE(header_offset+0x00,stream->streamfile);
-        step_index = read_8bit(header_offset+0x02,stream->streamfile);
+        hist1   = get_s16le(frame + header_pos + 0x00);
+        step_index = get_s8(frame + header_pos + 0x02);
         if (step_index < 0) step_index=0;
         if (step_index > 88) step_index=88;
 
@@ -729,14 +814,14 @@ void decode_xbox_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
     /* decode nibbles (layout: straight in mono or 4 bytes per channel in stereo) */
     for (i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = is_stereo ?
-                frame_offset + 0x04*2 + 0x04*(channel % 2) + 0x04*2*((i-1)/8) + ((i-1)%8)/2 :
-                frame_offset + 0x04   + (i-1)/2;
+        int pos = is_stereo ?
+                0x04*2 + 0x04*(channel % 2) + 0x04*2*((i-1)/8) + ((i-1)%8)/2 :
+                0x04   + (i-1)/2;
         int nibble_shift = (!((i-1)&1)   ? 0:4);   /* low first */
 
         /* must skip last nibble per spec, rarely needed though (ex. Gauntlet Dark Legacy) */
         if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+            std_ima_expand_nibble_data(frame[pos], nibble_shift, &hist1, &step_index);
             outbuf[sample_pos] = (short)(hist1);
             sample_pos += channelspacing;
         }
@@ -748,6 +833,7 @@ void decode_xbox_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 
 /* Multichannel XBOX-IMA ADPCM, with all channels mixed in the same block (equivalent to multichannel MS-IMA; seen in .rsd XADP). */
 void decode_xbox_ima_mch(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, sample_count = 0, num_frame;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -773,6 +859,8 @@ void decode_xbox_ima_mch(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
         samples_to_do -= 1;
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x24*channelspacing*(num_frame + 1));
+
     /* decode nibbles (layout: alternates 4 bytes/4*2 nibbles per channel) */
     for (i = first_sample; i < first_sample + samples_to_do; i++) {
         off_t byte_offset = (stream->offset + 0x24*channelspacing*num_frame + 0x04*channelspacing) + 0x04*channel + 0x04*channelspacing*((i-1)/8) + ((i-1)%8)/2;
@@ -780,7 +868,7 @@ void decode_xbox_ima_mch(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
 
         /* must skip last nibble per spec, rarely needed though */
         if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+            std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
             outbuf[sample_count] = (short)(hist1);
             sample_count += channelspacing;
         }
@@ -794,6 +882,7 @@ void decode_xbox_ima_mch(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
  * Apparently clamps to -32767 unlike standard's -32768 (probably not noticeable).
  * Info here: http://problemkaputt.de/gbatek.htm#dssoundnotes */
 void decode_nds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -810,13 +899,15 @@ void decode_nds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
         if (step_index > 88) step_index=88;
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x04 + (first_sample + samples_to_do - 1)/2 + 1);
+
     /* decode nibbles (layout: all nibbles from the channel) */
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + 0x04 + i/2;
         int nibble_shift = (i&1?4:0); /* low nibble first */
 
         //todo waveform has minor deviations using known expands
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -825,6 +916,7 @@ void decode_nds_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 }
 
 void decode_dat4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_16;//todo unneeded 16?
     int step_index = stream->adpcm_step_index;
@@ -840,11 +932,13 @@ void decode_dat4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
         step_index = _clamp_s32(step_index, 0, 88); /* probably pre-adjusted */
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x04 + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + 4 + i/2;
         int nibble_shift = (i&1?0:4); //high nibble first
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -853,6 +947,7 @@ void decode_dat4_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelsp
 }
 
 void decode_rad_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do,int channel) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -871,11 +966,13 @@ void decode_rad_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample_t *
         if (step_index > 88) step_index=88;
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 4*vgmstream->channels + channel + (first_sample + samples_to_do - 1)/2*vgmstream->channels + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + 4*vgmstream->channels + channel + i/2*vgmstream->channels;
         int nibble_shift = (i&1?4:0); //low nibble first
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -887,6 +984,7 @@ void decode_rad_ima(VGMSTREAM * vgmstream,VGMSTREAMCHANNEL * stream, sample_t *
 }
 
 void decode_rad_ima_mono(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -905,11 +1003,13 @@ void decode_rad_ima_mono(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
         if (step_index > 88) step_index=88;
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x04 + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + 4 + i/2;
         int nibble_shift = (i&1?4:0); //low nibble first
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -919,6 +1019,7 @@ void decode_rad_ima_mono(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int chann
 
 /* Apple's IMA4, a.k.a QuickTime IMA. 2 byte header and header sample is not written (setup only). */
 void decode_apple_ima4(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    uint8_t frame[0x22];
     int i, sample_count, num_frame;
     int16_t hist1 = stream->adpcm_history1_16;//todo unneeded 16?
     int step_index = stream->adpcm_step_index;
@@ -928,21 +1029,21 @@ void decode_apple_ima4(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channel
     num_frame = first_sample / block_samples;
     first_sample = first_sample % block_samples;
 
+    ima_read_frame(frame, stream->offset + 0x22*num_frame, sizeof(frame), stream->streamfile);
+
     //2-byte header
     if (first_sample == 0) {
-        off_t header_offset = stream->offset + 0x22*num_frame;
-
-        hist1 = (int16_t)((uint16_t)read_16bitBE(header_offset,stream->streamfile) & 0xff80);
-        step_index = read_8bit(header_offset+1,stream->streamfile) & 0x7f;
+        hist1 = (int16_t)(get_u16be(frame + 0x00) & 0xff80);
+        step_index = get_u8(frame + 0x01) & 0x7f;
         if (step_index < 0) step_index=0;
         if (step_index > 88) step_index=88;
     }
 
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
-        off_t byte_offset = (stream->offset + 0x22*num_frame + 0x2) + i/2;
+        int pos = 0x02 + i/2;
         int nibble_shift = (i&1?4:0); //low nibble first
 
-        std_ima_expand_nibble_16(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_16(frame[pos], nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -952,6 +1053,7 @@ void decode_apple_ima4(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channel
 
 /* XBOX-IMA with modified data layout */
 void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do,int channel) {
+    ima_buf_t buf;
     int i, sample_count = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -977,6 +1079,8 @@ void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
         samples_to_do -= 1;
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x24*vgmstream->channels);
+
     /* decode nibbles (layout: 2 bytes/2*2 nibbles per channel) */
     for (i = first_sample; i < first_sample + samples_to_do; i++) {
         off_t byte_offset = stream->offset + 0x04*vgmstream->channels + 0x02*channel + (i-1)/4*2*vgmstream->channels + ((i-1)%4)/2;
@@ -984,7 +1088,7 @@ void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
 
         /* must skip last nibble per official decoder, probably not needed though */
         if (i < block_samples) {
-            std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+            std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
             outbuf[sample_count] = (short)(hist1);
             sample_count += channelspacing;
         }
@@ -1001,6 +1105,7 @@ void decode_fsb_ima(VGMSTREAM * vgmstream, VGMSTREAMCHANNEL * stream, sample_t *
 
 /* mono XBOX-IMA with header endianness and alt nibble expand (verified vs AK test demos) */
 void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t* outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    uint8_t frame[0x24];
     int i, sample_count = 0, num_frame;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -1010,13 +1115,12 @@ void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t*
     num_frame = first_sample / block_samples;
     first_sample = first_sample % block_samples;
 
+    ima_read_frame(frame, stream->offset + 0x24*num_frame, sizeof(frame), stream->streamfile);
+
     /* normal header (hist+step+reserved), single channel */
     if (first_sample == 0) {
-        int16_t (*read_16bit)(off_t,STREAMFILE*) = vgmstream->codec_endian ? read_16bitBE : read_16bitLE;
-        off_t header_offset = stream->offset + 0x24*num_frame;
-
-        hist1 = read_16bit(header_offset,stream->streamfile);
-        step_index = read_8bit(header_offset+2,stream->streamfile);
+        hist1 = vgmstream->codec_endian ? get_s16be(frame + 0x00) : get_s16le(frame + 0x00);
+        step_index = get_s8(frame + 0x02);
         if (step_index < 0) step_index=0;
         if (step_index > 88) step_index=88;
 
@@ -1029,12 +1133,12 @@ void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t*
 
     /* decode nibbles (layout: all nibbles from one channel) */
     for (i = first_sample; i < first_sample + samples_to_do; i++) {
-        off_t byte_offset = (stream->offset + 0x24*num_frame + 0x4) + (i-1)/2;
+        int pos = 0x04 + (i-1)/2;
         int nibble_shift = ((i-1)&1?4:0); /* low nibble first */
 
         /* must skip last nibble like other XBOX-IMAs, often needed (ex. Bayonetta 2 sfx) */
         if (i < block_samples) {
-            std_ima_expand_nibble_mul(stream, byte_offset,nibble_shift, &hist1, &step_index);
+            std_ima_expand_nibble_mul(frame[pos], nibble_shift, &hist1, &step_index);
             outbuf[sample_count] = (short)(hist1);
             sample_count += channelspacing;
         }
@@ -1046,6 +1150,7 @@ void decode_wwise_ima(VGMSTREAM* vgmstream, VGMSTREAMCHANNEL* stream, sample_t*
 
 /* MS-IMA with possibly the XBOX-IMA model of even number of samples per block (more tests are needed) */
 void decode_awc_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do) {
+    ima_buf_t buf;
     int i, sample_count;
 
     int32_t hist1 = stream->adpcm_history1_32;
@@ -1065,11 +1170,13 @@ void decode_awc_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
         if (step_index > 88) step_index=88;
     }
 
+    ima_buf_init(&buf, stream->streamfile, stream->offset + 0x04 + (first_sample + samples_to_do - 1)/2 + 1);
+
     for (i=first_sample,sample_count=0; i<first_sample+samples_to_do; i++,sample_count+=channelspacing) {
         off_t byte_offset = stream->offset + 4 + i/2;
         int nibble_shift = (i&1?4:0); //low nibble first
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1);
     }
 
@@ -1083,6 +1190,7 @@ void decode_awc_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
 /* DVI stereo/mono with some mini header and sample output */
 void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, sample_count = 0;
 
     int32_t hist1 = stream->adpcm_history1_32;
@@ -1129,6 +1237,10 @@ void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
     if (step_index < 0) step_index = 0;
     if (step_index > 88) step_index = 88;
 
+    ima_buf_init(&buf, stream->streamfile, channelspacing == 1 ?
+            stream->offset + (first_sample + samples_to_do - 1)/2 + 1 :
+            stream->offset + first_sample + samples_to_do);
+
     for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
         off_t byte_offset = channelspacing == 1 ?
                 stream->offset + i/2 :  /* mono mode */
@@ -1137,7 +1249,7 @@ void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
                 (!(i%2) ? 4:0) :        /* mono mode (high first) */
                 (channel==0 ? 4:0);     /* stereo mode (high=L,low=R) */
 
-        std_ima_expand_nibble_mul(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_mul(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1); /* all samples are written */
     }
 
@@ -1147,6 +1259,7 @@ void decode_ubi_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
 
 /* standard IMA but with a tweak for Ubi's encoder bug with step index (see blocked_ubi_sce.c) */
 void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel) {
+    ima_buf_t buf;
     int i, sample_count = 0;
 
     int32_t hist1 = stream->adpcm_history1_32;
@@ -1157,6 +1270,10 @@ void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
     if (step_index < 0) step_index = 0;
     if (step_index > 89) step_index = 89;
 
+    ima_buf_init(&buf, stream->streamfile, channelspacing == 1 ?
+            stream->offset + (first_sample + samples_to_do - 1)/2 + 1 :
+            stream->offset + first_sample + samples_to_do);
+
     for (i = first_sample; i < first_sample + samples_to_do; i++, sample_count += channelspacing) {
         off_t byte_offset = channelspacing == 1 ?
                 stream->offset + i/2 :  /* mono mode */
@@ -1165,7 +1282,7 @@ void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
                 (!(i%2) ? 4:0) :        /* mono mode (high first) */
                 (channel==0 ? 4:0);     /* stereo mode (high=L,low=R) */
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
         outbuf[sample_count] = (short)(hist1); /* all samples are written */
     }
 
@@ -1178,6 +1295,7 @@ void decode_ubi_sce_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channe
  * tables mapping all standard IMA combinations (to optimize calculations), but decodes the same.
  * Based on HCS's and Nisto's reverse engineering in h4m_audio_decode. */
 void decode_h4m_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspacing, int32_t first_sample, int32_t samples_to_do, int channel, uint16_t frame_format) {
+    ima_buf_t buf;
     int i, samples_done = 0;
     int32_t hist1 = stream->adpcm_history1_32;
     int step_index = stream->adpcm_step_index;
@@ -1228,6 +1346,10 @@ void decode_h4m_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
         default: header_size = 0; break;
     }
 
+    ima_buf_init(&buf, stream->streamfile, is_stereo ?
+            stream->offset + header_size + first_sample + samples_to_do :
+            stream->offset + header_size + (first_sample + samples_to_do - 1)/2 + 1);
+
     /* decode block nibbles */
     for (i = first_sample; i < first_sample + samples_to_do; i++) {
         off_t byte_offset = is_stereo ?
@@ -1237,7 +1359,7 @@ void decode_h4m_ima(VGMSTREAMCHANNEL * stream, sample_t * outbuf, int channelspa
                 (!(channel&1) ? 0:4) :                  /* stereo: L=low, R=high */
                 (!(i&1) ? 0:4);                         /* mono: low first */
 
-        std_ima_expand_nibble(stream, byte_offset,nibble_shift, &hist1, &step_index);
+        std_ima_expand_nibble_data(ima_buf_get(&buf, byte_offset), nibble_shift, &hist1, &step_index);
 
         outbuf[samples_done * channelspacing] = (short)(hist1);
         samples_done++;
@@ -404,7 +404,7 @@ fail:
 
 /* **************************************** */
 
-static void expand_vima(imuse_codec_data* data, bitstream_t* is, int ch, int s) {
+static void expand_vima(imuse_codec_data* data, bm_cache_t* is, int ch, int s) {
     bool is_v1 = data->type == COMP;
 
     int step_index = data->adpcm_step_index[ch];
@@ -418,12 +418,12 @@ static void expand_vima(imuse_codec_data* data, bitstream_t* is, int ch, int s)
     int sign_mask = (1 << (code_bits - 1));
     int data_mask = (sign_mask - 1); // LUT in COMI
 
-    int code = bm_read(is, code_bits);
+    int code = bmc_read(is, code_bits);
     int code_base = code & data_mask;
 
     // all bits set means 'keyframe' = read next BE sample
     if (!is_v1 && code_base == data_mask) {
-        sample = (short)bm_read(is, 16);
+        sample = (short)bmc_read(is, 16);
     }
     else {
         int adpcm_index = (code_base << code_shift);
@@ -503,9 +503,9 @@ static int decode_vima_comp(imuse_codec_data* data, block_entry_t* entry) {
         }
     }
 
-    bitstream_t is = {0};
-    bm_setup(&is, data->block, entry->size); // original BR reads max 16 bit per call
-    bm_skip(&is, pos * 8);
+    bm_cache_t is = {0};
+    bmc_setup(&is, data->block, entry->size); // original BR reads max 16 bit per call
+    bmc_skip(&is, pos * 8);
 
     /* decode ADPCM data after header (stereo layout: all samples from L, then all for R) */
     int samples_left = data_left / sizeof(short);
@@ -562,9 +562,9 @@ static int decode_vima_mcmp(imuse_codec_data* data, block_entry_t* entry) {
         }
     }
 
-    bitstream_t is = {0};
-    bm_setup(&is, data->block, entry->size); // original BR reads max 16 bit per call
-    bm_skip(&is, pos * 8);
+    bm_cache_t is = {0};
+    bmc_setup(&is, data->block, entry->size); // original BR reads max 16 bit per call
+    bmc_skip(&is, pos * 8);
 
     /* decode ADPCM data after header (stereo layout: all samples from L, then all for R) */
     int samples_left = data_left / sizeof(short);
@@ -602,9 +602,9 @@ static int decode_vima_aifc(imuse_codec_data* data, block_entry_t* entry) {
         data->adpcm_step_index[1] = clamp_s32(data->adpcm_step_index[1], 0, 88);
     }
 
-    bitstream_t is = {0};
-    bm_setup(&is, data->block, entry->size); // original BR reads max 16 bit per call
-    bm_skip(&is, pos * 8);
+    bm_cache_t is = {0};
+    bmc_setup(&is, data->block, entry->size); // original BR reads max 16 bit per call
+    bmc_skip(&is, pos * 8);
 
     /* decode ADPCM data after header (stereo layout: L then R xN) */
     int samples_left = data_left / sizeof(short);
@@ -363,6 +363,15 @@ void clHCA_ReadSamples(clHCA* hca, float* samples) {
     }
 }
 
+void clHCA_ReadSamplesPlanar(clHCA* hca, float* samples) {
+
+    /* each channel's subframes are contiguous, copy as-is */
+    for (int k = 0; k < hca->channels; k++) {
+        memcpy(samples, hca->channel[k].wave, HCA_SUBFRAMES * HCA_SAMPLES_PER_SUBFRAME * sizeof(float));
+        samples += HCA_SUBFRAMES * HCA_SAMPLES_PER_SUBFRAME;
+    }
+}
+
 
 //--------------------------------------------------
 // Allocation and creation
@@ -66,6 +66,8 @@ int clHCA_DecodeBlock(clHCA* hca, void* data, unsigned int size);
  * next decode. Buffer must be at least (samplesPerBlock*channels) long. */
 void clHCA_ReadSamples16(clHCA* hca, short* samples);
 void clHCA_ReadSamples(clHCA* hca, float* samples);
+/* Same as above but in planar order (all samples of first channel, then next channel, etc). */
+void clHCA_ReadSamplesPlanar(clHCA* hca, float* samples);
 
 
 /* Sets a 64 bit encryption key, to properly decode blocks. This may be called
@@ -17,6 +17,26 @@
  * (function call is optimized out by compiler). */
 #define TAC_ENABLE_PS2_FLOATS  0
 
+/* Ops on all 4 lanes (most of the transform and some unpacking) can be done with SSE2 vector ops. On x86-64
+ * scalar float ops are also SSE (IEEE single precision with the same rounding), so results are bit-identical.
+ * Not done when FMA is available, as compiler may fuse scalar MADDs, or when simulating PS2 floats.
+ * Partial lanes use the scalar code (dest is a constant so the check is resolved on compile time). */
+#define TAC_ENABLE_SIMD  1
+
+#if TAC_ENABLE_SIMD && !TAC_ENABLE_PS2_FLOATS && (defined(__x86_64__) || defined(_M_X64)) && !defined(__FMA__)
+#include <emmintrin.h>
+#define VF_LOAD(vf)         _mm_loadu_ps((vf)->F)
+#define VF_LOADI(vf)        _mm_loadu_si128((const __m128i*)(vf)->SL)
+#define VF_BCAST(vf, n)     _mm_set1_ps((vf)->F[n])
+#define VF_SIMD(dest, vf, value) \
+    if (dest == _xyzw) { _mm_storeu_ps((vf)->F, value); return; }
+#define VF_SIMDI(dest, vf, value) \
+    if (dest == _xyzw) { _mm_storeu_si128((__m128i*)(vf)->SL, value); return; }
+#else
+#define VF_SIMD(dest, vf, value)    /* nothing */
+#define VF_SIMDI(dest, vf, value)   /* nothing */
+#endif
+
 static inline void UPDATE_FLOATS(uint8_t dest, REG_VF *vf) {
 #if TAC_ENABLE_PS2_FLOATS
     int i;
@@ -71,6 +91,7 @@ static inline void _DIV_INTERNAL(REG_VF *fd, const REG_VF *fs, const REG_VF *ft,
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void DIV(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_div_ps(VF_LOAD(fs), VF_LOAD(ft)));
     if (dest & _x___) _DIV_INTERNAL(fd, fs, ft, 0);
     if (dest & __y__) _DIV_INTERNAL(fd, fs, ft, 1);
     if (dest & ___z_) _DIV_INTERNAL(fd, fs, ft, 2);
@@ -81,6 +102,7 @@ static inline void DIV(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void ADD(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fs), VF_LOAD(ft)));
     if (dest & _x___) fd->f.x = fs->f.x + ft->f.x;
     if (dest & __y__) fd->f.y = fs->f.y + ft->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z + ft->f.z;
@@ -89,6 +111,7 @@ static inline void ADD(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void ADDx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fs), VF_BCAST(ft, 0)));
     if (dest & _x___) fd->f.x = fs->f.x + ft->f.x;
     if (dest & __y__) fd->f.y = fs->f.y + ft->f.x;
     if (dest & ___z_) fd->f.z = fs->f.z + ft->f.x;
@@ -97,6 +120,7 @@ static inline void ADDx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void ADDy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fs), VF_BCAST(ft, 1)));
     if (dest & _x___) fd->f.x = fs->f.x + ft->f.y;
     if (dest & __y__) fd->f.y = fs->f.y + ft->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z + ft->f.y;
@@ -105,6 +129,7 @@ static inline void ADDy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void ADDz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fs), VF_BCAST(ft, 2)));
     if (dest & _x___) fd->f.x = fs->f.x + ft->f.z;
     if (dest & __y__) fd->f.y = fs->f.y + ft->f.z;
     if (dest & ___z_) fd->f.z = fs->f.z + ft->f.z;
@@ -113,6 +138,7 @@ static inline void ADDz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void ADDw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fs), VF_BCAST(ft, 3)));
     if (dest & _x___) fd->f.x = fs->f.x + ft->f.w;
     if (dest & __y__) fd->f.y = fs->f.y + ft->f.w;
     if (dest & ___z_) fd->f.z = fs->f.z + ft->f.w;
@@ -123,6 +149,7 @@ static inline void ADDw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void SUB(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fs), VF_LOAD(ft)));
     if (dest & _x___) fd->f.x = fs->f.x - ft->f.x;
     if (dest & __y__) fd->f.y = fs->f.y - ft->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z - ft->f.z;
@@ -131,6 +158,7 @@ static inline void SUB(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void SUBx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fs), VF_BCAST(ft, 0)));
     if (dest & _x___) fd->f.x = fs->f.x - ft->f.x;
     if (dest & __y__) fd->f.y = fs->f.y - ft->f.x;
     if (dest & ___z_) fd->f.z = fs->f.z - ft->f.x;
@@ -139,6 +167,7 @@ static inline void SUBx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void SUBy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fs), VF_BCAST(ft, 1)));
     if (dest & _x___) fd->f.x = fs->f.x - ft->f.y;
     if (dest & __y__) fd->f.y = fs->f.y - ft->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z - ft->f.y;
@@ -147,6 +176,7 @@ static inline void SUBy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void SUBz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fs), VF_BCAST(ft, 2)));
     if (dest & _x___) fd->f.x = fs->f.x - ft->f.z;
     if (dest & __y__) fd->f.y = fs->f.y - ft->f.z;
     if (dest & ___z_) fd->f.z = fs->f.z - ft->f.z;
@@ -155,6 +185,7 @@ static inline void SUBz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void SUBw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fs), VF_BCAST(ft, 3)));
     if (dest & _x___) fd->f.x = fs->f.x - ft->f.w;
     if (dest & __y__) fd->f.y = fs->f.y - ft->f.w;
     if (dest & ___z_) fd->f.z = fs->f.z - ft->f.w;
@@ -165,6 +196,7 @@ static inline void SUBw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void MUL(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fs), VF_LOAD(ft)));
     if (dest & _x___) fd->f.x = fs->f.x * ft->f.x;
     if (dest & __y__) fd->f.y = fs->f.y * ft->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z * ft->f.z;
@@ -173,6 +205,7 @@ static inline void MUL(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void MULx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 0)));
     if (dest & _x___) fd->f.x = fs->f.x * ft->f.x;
     if (dest & __y__) fd->f.y = fs->f.y * ft->f.x;
     if (dest & ___z_) fd->f.z = fs->f.z * ft->f.x;
@@ -181,6 +214,7 @@ static inline void MULx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void MULy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 1)));
     if (dest & _x___) fd->f.x = fs->f.x * ft->f.y;
     if (dest & __y__) fd->f.y = fs->f.y * ft->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z * ft->f.y;
@@ -189,6 +223,7 @@ static inline void MULy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void MULz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 2)));
     if (dest & _x___) fd->f.x = fs->f.x * ft->f.z;
     if (dest & __y__) fd->f.y = fs->f.y * ft->f.z;
     if (dest & ___z_) fd->f.z = fs->f.z * ft->f.z;
@@ -197,6 +232,7 @@ static inline void MULz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void MULw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 3)));
     if (dest & _x___) fd->f.x = fs->f.x * ft->f.w;
     if (dest & __y__) fd->f.y = fs->f.y * ft->f.w;
     if (dest & ___z_) fd->f.z = fs->f.z * ft->f.w;
@@ -207,6 +243,7 @@ static inline void MULw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void MADD(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_LOAD(ft))));
     if (dest & _x___) fd->f.x = fd->f.x + (fs->f.x * ft->f.x);
     if (dest & __y__) fd->f.y = fd->f.y + (fs->f.y * ft->f.y);
     if (dest & ___z_) fd->f.z = fd->f.z + (fs->f.z * ft->f.z);
@@ -215,6 +252,7 @@ static inline void MADD(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF
 }
 
 static inline void MADDx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 0))));
     if (dest & _x___) fd->f.x = fd->f.x + (fs->f.x * ft->f.x);
     if (dest & __y__) fd->f.y = fd->f.y + (fs->f.y * ft->f.x);
     if (dest & ___z_) fd->f.z = fd->f.z + (fs->f.z * ft->f.x);
@@ -223,6 +261,7 @@ static inline void MADDx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MADDy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 1))));
     if (dest & _x___) fd->f.x = fd->f.x + (fs->f.x * ft->f.y);
     if (dest & __y__) fd->f.y = fd->f.y + (fs->f.y * ft->f.y);
     if (dest & ___z_) fd->f.z = fd->f.z + (fs->f.z * ft->f.y);
@@ -231,6 +270,7 @@ static inline void MADDy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MADDz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 2))));
     if (dest & _x___) fd->f.x = fd->f.x + (fs->f.x * ft->f.z);
     if (dest & __y__) fd->f.y = fd->f.y + (fs->f.y * ft->f.z);
     if (dest & ___z_) fd->f.z = fd->f.z + (fs->f.z * ft->f.z);
@@ -239,6 +279,7 @@ static inline void MADDz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MADDw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_add_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 3))));
     if (dest & _x___) fd->f.x = fd->f.x + (fs->f.x * ft->f.w);
     if (dest & __y__) fd->f.y = fd->f.y + (fs->f.y * ft->f.w);
     if (dest & ___z_) fd->f.z = fd->f.z + (fs->f.z * ft->f.w);
@@ -247,6 +288,7 @@ static inline void MADDw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MSUBx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 0))));
     if (dest & _x___) fd->f.x = fd->f.x - (fs->f.x * ft->f.x);
     if (dest & __y__) fd->f.y = fd->f.y - (fs->f.y * ft->f.x);
     if (dest & ___z_) fd->f.z = fd->f.z - (fs->f.z * ft->f.x);
@@ -255,6 +297,7 @@ static inline void MSUBx(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MSUBy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 1))));
     if (dest & _x___) fd->f.x = fd->f.x - (fs->f.x * ft->f.y);
     if (dest & __y__) fd->f.y = fd->f.y - (fs->f.y * ft->f.y);
     if (dest & ___z_) fd->f.z = fd->f.z - (fs->f.z * ft->f.y);
@@ -263,6 +306,7 @@ static inline void MSUBy(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MSUBz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 2))));
     if (dest & _x___) fd->f.x = fd->f.x - (fs->f.x * ft->f.z);
     if (dest & __y__) fd->f.y = fd->f.y - (fs->f.y * ft->f.z);
     if (dest & ___z_) fd->f.z = fd->f.z - (fs->f.z * ft->f.z);
@@ -271,6 +315,7 @@ static inline void MSUBz(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 }
 
 static inline void MSUBw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_VF *ft) {
+    VF_SIMD(dest, fd, _mm_sub_ps(VF_LOAD(fd), _mm_mul_ps(VF_LOAD(fs), VF_BCAST(ft, 3))));
     if (dest & _x___) fd->f.x = fd->f.x - (fs->f.x * ft->f.w);
     if (dest & __y__) fd->f.y = fd->f.y - (fs->f.y * ft->f.w);
     if (dest & ___z_) fd->f.z = fd->f.z - (fs->f.z * ft->f.w);
@@ -281,6 +326,7 @@ static inline void MSUBw(uint8_t dest, REG_VF *fd, const REG_VF *fs, const REG_V
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void FMUL(uint8_t dest, REG_VF *fd, const REG_VF *fs, const float I_F) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fs), _mm_set1_ps(I_F)));
     if (dest & _x___) fd->f.x = fs->f.x * I_F;
     if (dest & __y__) fd->f.y = fs->f.y * I_F;
     if (dest & ___z_) fd->f.z = fs->f.z * I_F;
@@ -289,6 +335,7 @@ static inline void FMUL(uint8_t dest, REG_VF *fd, const REG_VF *fs, const float
 }
 
 static inline void FMULf(uint8_t dest, REG_VF *fd, const float fs) {
+    VF_SIMD(dest, fd, _mm_mul_ps(VF_LOAD(fd), _mm_set1_ps(fs)));
     if (dest & _x___) fd->f.x = fd->f.x * fs;
     if (dest & __y__) fd->f.y = fd->f.y * fs;
     if (dest & ___z_) fd->f.z = fd->f.z * fs;
@@ -299,6 +346,7 @@ static inline void FMULf(uint8_t dest, REG_VF *fd, const float fs) {
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void ABS(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
+    VF_SIMD(dest, ft, _mm_andnot_ps(_mm_set1_ps(-0.0f), VF_LOAD(fs)));
     if (dest & _x___) ft->f.x = fabsf(fs->f.x);
     if (dest & __y__) ft->f.y = fabsf(fs->f.y);
     if (dest & ___z_) ft->f.z = fabsf(fs->f.z);
@@ -306,6 +354,7 @@ static inline void ABS(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
 }
 
 static inline void FTOI0(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
+    VF_SIMDI(dest, ft, _mm_cvttps_epi32(VF_LOAD(fs)));
     if (dest & _x___) ft->SL[0] = (int32_t)fs->f.x;
     if (dest & __y__) ft->SL[1] = (int32_t)fs->f.y;
     if (dest & ___z_) ft->SL[2] = (int32_t)fs->f.z;
@@ -313,6 +362,7 @@ static inline void FTOI0(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
 }
 
 static inline void ITOF0(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
+    VF_SIMD(dest, ft, _mm_cvtepi32_ps(VF_LOADI(fs)));
     if (dest & _x___) ft->f.x = (float)fs->SL[0];
     if (dest & __y__) ft->f.y = (float)fs->SL[1];
     if (dest & ___z_) ft->f.z = (float)fs->SL[2];
@@ -320,6 +370,7 @@ static inline void ITOF0(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
 }
 
 static inline void MR32(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
+    VF_SIMD(dest, ft, _mm_shuffle_ps(VF_LOAD(fs), VF_LOAD(fs), _MM_SHUFFLE(0,3,2,1)));
     float x = fs->f.x;
     if (dest & _x___) ft->f.x = fs->f.y;
     if (dest & __y__) ft->f.y = fs->f.z;
@@ -330,6 +381,7 @@ static inline void MR32(uint8_t dest, REG_VF *ft, const REG_VF *fs) {
 ///////////////////////////////////////////////////////////////////////////////
 
 static inline void LOAD(uint8_t dest, REG_VF *ft, REG_VF* src, int pos) {
+    VF_SIMD(dest, ft, VF_LOAD(&src[pos]));
     if (dest & _x___) ft->f.x = src[pos].f.x;
     if (dest & __y__) ft->f.y = src[pos].f.y;
     if (dest & ___z_) ft->f.z = src[pos].f.z;
@@ -337,6 +389,7 @@ static inline void LOAD(uint8_t dest, REG_VF *ft, REG_VF* src, int pos) {
 }
 
 static inline void STORE(uint8_t dest, REG_VF* dst, const REG_VF *fs, int pos) {
+    VF_SIMD(dest, &dst[pos], VF_LOAD(fs));
     if (dest & _x___) dst[pos].f.x = fs->f.x;
     if (dest & __y__) dst[pos].f.y = fs->f.y;
     if (dest & ___z_) dst[pos].f.z = fs->f.z;
@@ -344,6 +397,7 @@ static inline void STORE(uint8_t dest, REG_VF* dst, const REG_VF *fs, int pos) {
 }
 
 static inline void MOVE(uint8_t dest, REG_VF *fd, const REG_VF *fs) {
+    VF_SIMD(dest, fd, VF_LOAD(fs));
     if (dest & _x___) fd->f.x = fs->f.x;
     if (dest & __y__) fd->f.y = fs->f.y;
     if (dest & ___z_) fd->f.z = fs->f.z;
@@ -351,6 +405,7 @@ static inline void MOVE(uint8_t dest, REG_VF *fd, const REG_VF *fs) {
 }
 
 static inline void MOVEx(uint8_t dest, REG_VF *fd, const REG_VF *fs) {
+    VF_SIMD(dest, fd, VF_BCAST(fs, 0));
     if (dest & _x___) fd->f.x = fs->f.x;
     if (dest & __y__) fd->f.y = fs->f.x;
     if (dest & ___z_) fd->f.z = fs->f.x;
@@ -358,6 +413,7 @@ static inline void MOVEx(uint8_t dest, REG_VF *fd, const REG_VF *fs) {
 }
 
 static inline void SIGN(uint8_t dest, REG_VF *fd, const REG_VF *fs) {
+    VF_SIMD(dest, fd, _mm_xor_ps(VF_LOAD(fd), _mm_and_ps(_mm_cmplt_ps(VF_LOAD(fs), _mm_setzero_ps()), _mm_set1_ps(-0.0f))));
     if (dest & _x___) if (fs->f.x < 0) fd->f.x = -fd->f.x;
     if (dest & __y__) if (fs->f.y < 0) fd->f.y = -fd->f.y;
     if (dest & ___z_) if (fs->f.z < 0) fd->f.z = -fd->f.z;
@@ -365,6 +421,7 @@ static inline void SIGN(uint8_t dest, REG_VF *fd, const REG_VF *fs) {
 }
 
 static inline void COPY(uint8_t dest, REG_VF *fd, const int16_t* buf) {
+    VF_SIMD(dest, fd, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), _mm_loadl_epi64((const __m128i*)buf)), 16)));
     if (dest & _x___) fd->f.x = buf[0];
     if (dest & __y__) fd->f.y = buf[1];
     if (dest & ___z_) fd->f.z = buf[2];
@@ -502,8 +502,7 @@ fail:
 
 /* converts an EALAYER3 frame to a standard MPEG frame from pre-parsed info */
 static int ealayer3_rebuild_mpeg_frame(bitstream_t* is_0, ealayer3_frame_t* eaf_0, bitstream_t* is_1, ealayer3_frame_t* eaf_1, bitstream_t* os) {
-    uint32_t c = 0;
-    int i, j;
+    int i;
     int expected_bitrate_index, expected_frame_size;
 
 
@@ -580,18 +579,12 @@ static int ealayer3_rebuild_mpeg_frame(bitstream_t* is_0, ealayer3_frame_t* eaf_
         /* write MPEG1 main data */
         bm_set(is_0, eaf_0->data_offset_b);
         for (i = 0; i < eaf_0->channels; i++) { /* granule0 */
-            for (j = 0; j < eaf_0->main_data_size[i]; j++) {
-                bm_get(is_0,  1, &c);
-                bm_put(os,    1,  c);
-            }
+            bm_copy(os, is_0, eaf_0->main_data_size[i]);
         }
 
         bm_set(is_1, eaf_1->data_offset_b);
         for (i = 0; i < eaf_1->channels; i++) { /* granule1 */
-            for (j = 0; j < eaf_1->main_data_size[i]; j++) {
-                bm_get(is_1,  1, &c);
-                bm_put(os,    1,  c);
-            }
+            bm_copy(os, is_1, eaf_1->main_data_size[i]);
         }
     }
     else {
@@ -610,10 +603,7 @@ static int ealayer3_rebuild_mpeg_frame(bitstream_t* is_0, ealayer3_frame_t* eaf_
         /* write MPEG2 main data */
         bm_set(is_0, eaf_0->data_offset_b);
         for (i = 0; i < eaf_0->channels; i++) {
-            for (j = 0; j < eaf_0->main_data_size[i]; j++) {
-                bm_get(is_0,  1, &c);
-                bm_put(os,    1,  c);
-            }
+            bm_copy(os, is_0, eaf_0->main_data_size[i]);
         }
     }
 
@@ -217,7 +217,8 @@ static bool decode_frame_ogg_vorbis(VGMSTREAM* v) {
     if (rc <= 0)  // rc is samples done
         return false;
 
-    sbuf_init_flt(&ds->sbuf, data->fbuf, rc, v->channels);
+    // vorbis's buffers are already planar, keep them that way (copied to the final buf later)
+    sbuf_init_planar(&ds->sbuf, SFMT_FLT, data->fbuf, rc, v->channels, rc);
     ds->sbuf.filled = rc;
 
     if (data->disable_reordering)
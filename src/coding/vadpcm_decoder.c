@@ -138,7 +138,7 @@ int32_t vadpcm_bytes_to_samples(size_t bytes, int channels) {
  * - j: order index (coefs for prev N hist samples)
  * - k: coef index (multiplication coefficient for 8 samples in a sub-frame)
  * coefs[i * (order*8) + j * 8 + k * order] = coefs[i][j][k] */
-void vadpcm_read_coefs_be(VGMSTREAM* vgmstream, STREAMFILE* sf, off_t offset, int order, int entries, int ch) {
+bool vadpcm_read_coefs_be(VGMSTREAM* vgmstream, STREAMFILE* sf, off_t offset, int order, int entries, int ch) {
     int i;
 
     if (entries > 8)
@@ -147,9 +147,16 @@ void vadpcm_read_coefs_be(VGMSTREAM* vgmstream, STREAMFILE* sf, off_t offset, in
     if (order != 2)
         order = 2;
 
+    /* +1 entry as decoder clamps bad indexes to 8 */
+    if (!vgmstream->ch[ch].vadpcm_coefs) {
+        vgmstream->ch[ch].vadpcm_coefs = calloc((8 + 1) * 2 * 8, sizeof(int16_t));
+        if (!vgmstream->ch[ch].vadpcm_coefs) return false;
+    }
+
     /* assumes all channels use same coefs, never seen non-mono files */
     for (i = 0; i < entries * order * 8; i++) {
         vgmstream->ch[ch].vadpcm_coefs[i] = read_s16be(offset + i*2, sf);
     }
     vgmstream->codec_config = order;
+    return true;
 }
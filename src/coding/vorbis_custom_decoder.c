@@ -9,6 +9,241 @@
 
 #define VORBIS_CALL_SAMPLES 1024  // allowed frame 'blocksizes' range from 2^6 ~ 2^13 (64 ~ 8192) but we can return partial samples
 #define VORBIS_DEFAULT_BUFFER_SIZE 0x8000 // at least the size of the setup header, ~0x2000
+#define VORBIS_SETUP_CACHE_MAX 8
+
+
+/* **************************************************************************** */
+/* SETUP CACHE                                                                  */
+/* **************************************************************************** */
+
+/* Rebuilding a setup (Wwise) and parsing it plus building codebooks (libvorbis) is the slowest part
+ * of opening a stream, but streams in the same bank/game nearly always share it. libvorbis only reads
+ * vorbis_info once vorbis_synthesis_init is done, so parsed infos can be shared between decoders. */
+
+/* Plugins may open files in multiple threads. The lock is a plain spinlock (no yield) since it's only held
+ * to find/update cache slots and refcounts, never while parsing a setup or building codebooks. */
+#if defined(_MSC_VER)
+#include <intrin.h>
+static volatile long setup_cache_lock = 0;
+#define SETUP_CACHE_LOCK()      while (_InterlockedExchange(&setup_cache_lock, 1)) { }
+#define SETUP_CACHE_UNLOCK()    _InterlockedExchange(&setup_cache_lock, 0)
+#elif defined(__GNUC__) || defined(__clang__)
+static volatile int setup_cache_lock = 0;
+#define SETUP_CACHE_LOCK()      while (__sync_lock_test_and_set(&setup_cache_lock, 1)) { }
+#define SETUP_CACHE_UNLOCK()    __sync_lock_release(&setup_cache_lock)
+#else
+#define SETUP_CACHE_DISABLED
+#define SETUP_CACHE_LOCK()
+#define SETUP_CACHE_UNLOCK()
+#endif
+
+/* config that affects the rebuilt headers */
+typedef struct {
+    vorbis_custom_t type;
+    int channels;
+    int sample_rate;
+    int blocksize_0_exp;
+    int blocksize_1_exp;
+    uint32_t setup_id;
+    wwise_setup_t setup_type;
+    wwise_packet_t packet_type;
+} vorbis_setup_key_t;
+
+struct vorbis_setup_t {
+    vorbis_setup_key_t key;
+    uint8_t* setup;                 /* original setup data, if any */
+    size_t setup_size;
+
+    vorbis_info vi;
+    uint8_t mode_blockflag[64+1];   /* Wwise */
+    int mode_bits;
+
+    int refs;
+    bool parsed;                    /* vi is set */
+    bool cached;                    /* in setup_cache list */
+    uint32_t last_use;
+};
+
+static vorbis_setup_t* setup_cache[VORBIS_SETUP_CACHE_MAX];
+static uint32_t setup_cache_ticks;
+static bool setup_cache_atexit;
+
+
+static void free_setup(vorbis_setup_t* entry) {
+    if (!entry)
+        return;
+    if (entry->parsed)
+        vorbis_info_clear(&entry->vi);
+    free(entry->setup);
+    free(entry);
+}
+
+static void make_setup_key(vorbis_setup_key_t* key, vorbis_custom_codec_data* data) {
+    memset(key, 0, sizeof(vorbis_setup_key_t)); /* for memcmp */
+    key->type = data->type;
+    key->channels = data->config.channels;
+    key->sample_rate = data->config.sample_rate;
+    key->blocksize_0_exp = data->config.blocksize_0_exp;
+    key->blocksize_1_exp = data->config.blocksize_1_exp;
+    key->setup_id = data->config.setup_id;
+    key->setup_type = data->config.setup_type;
+    key->packet_type = data->config.packet_type;
+}
+
+bool vorbis_custom_setup_cache_load(vorbis_custom_codec_data* data, const uint8_t* setup, size_t setup_size) {
+    vorbis_setup_key_t key;
+    vorbis_setup_t* entry = NULL;
+
+#ifdef SETUP_CACHE_DISABLED
+    return false;
+#endif
+
+    make_setup_key(&key, data);
+
+    SETUP_CACHE_LOCK();
+    for (int i = 0; i < VORBIS_SETUP_CACHE_MAX; i++) {
+        vorbis_setup_t* test = setup_cache[i];
+        if (!test || test->setup_size != setup_size)
+            continue;
+        if (memcmp(&test->key, &key, sizeof(vorbis_setup_key_t)) != 0)
+            continue;
+        if (setup_size && memcmp(test->setup, setup, setup_size) != 0)
+            continue;
+
+        entry = test;
+        entry->refs++;
+        entry->last_use = ++setup_cache_ticks;
+        break;
+    }
+    SETUP_CACHE_UNLOCK();
+
+    if (entry) {
+        data->setup = entry;
+        memcpy(data->mode_blockflag, entry->mode_blockflag, sizeof(data->mode_blockflag));
+        data->mode_bits = entry->mode_bits;
+        return true;
+    }
+
+    /* new entry, filled and added once the caller parses the setup (works uncached if this fails) */
+    entry = calloc(1, sizeof(vorbis_setup_t));
+    if (!entry) return false;
+
+    if (setup_size) {
+        entry->setup = malloc(setup_size);
+        if (!entry->setup) {
+            free(entry);
+            return false;
+        }
+        memcpy(entry->setup, setup, setup_size);
+    }
+    entry->setup_size = setup_size;
+    entry->key = key;
+    entry->refs = 1;
+
+    data->setup = entry;
+    return false;
+}
+
+/* moves a new parsed setup to its entry, must be done before vorbis_synthesis_init (as vd points to vi) */
+static vorbis_info* get_setup_info(vorbis_custom_codec_data* data) {
+    vorbis_setup_t* entry = data->setup;
+
+    if (!entry)
+        return &data->vi;
+
+    if (!entry->parsed) {
+        entry->vi = data->vi;
+        vorbis_info_init(&data->vi);
+        memcpy(entry->mode_blockflag, data->mode_blockflag, sizeof(entry->mode_blockflag));
+        entry->mode_bits = data->mode_bits;
+        entry->parsed = true;
+    }
+
+    return &entry->vi;
+}
+
+/* Frees cached entries on exit (or when a plugin's DLL/.so is unloaded, as atexit is per module there).
+ * Entries still used by open streams are just removed, and freed once released. */
+static void setup_cache_clear(void) {
+    vorbis_setup_t* unused[VORBIS_SETUP_CACHE_MAX] = {0};
+
+    SETUP_CACHE_LOCK();
+    for (int i = 0; i < VORBIS_SETUP_CACHE_MAX; i++) {
+        vorbis_setup_t* entry = setup_cache[i];
+        if (!entry)
+            continue;
+
+        entry->cached = false;
+        if (entry->refs <= 0)
+            unused[i] = entry;
+        setup_cache[i] = NULL;
+    }
+    SETUP_CACHE_UNLOCK();
+
+    for (int i = 0; i < VORBIS_SETUP_CACHE_MAX; i++) {
+        free_setup(unused[i]);
+    }
+}
+
+/* adds a new entry to the cache once vorbis_synthesis_init has built the codebooks (shared from then on) */
+static void setup_cache_add(vorbis_setup_t* entry) {
+    vorbis_setup_t* evicted = NULL;
+    int slot = -1;
+    bool register_clear = false;
+
+    if (!entry || entry->cached)
+        return;
+
+    SETUP_CACHE_LOCK();
+    for (int i = 0; i < VORBIS_SETUP_CACHE_MAX; i++) {
+        vorbis_setup_t* test = setup_cache[i];
+        if (!test) {
+            slot = i;
+            break;
+        }
+
+        /* least recently used among unused entries */
+        if (test->refs == 0 && (slot < 0 || test->last_use < setup_cache[slot]->last_use))
+            slot = i;
+    }
+
+    if (slot >= 0) {
+        evicted = setup_cache[slot];
+        setup_cache[slot] = entry;
+        entry->cached = true;
+        entry->last_use = ++setup_cache_ticks;
+
+        register_clear = !setup_cache_atexit;
+        setup_cache_atexit = true;
+    }
+    SETUP_CACHE_UNLOCK();
+
+    free_setup(evicted);
+
+    if (register_clear)
+        atexit(setup_cache_clear);
+}
+
+/* unused entries are kept in cache for next streams, or freed if it couldn't be added */
+static void setup_cache_release(vorbis_setup_t* entry) {
+    bool is_unused;
+
+    if (!entry)
+        return;
+
+    SETUP_CACHE_LOCK();
+    entry->refs--;
+    is_unused = (entry->refs <= 0 && !entry->cached);
+    SETUP_CACHE_UNLOCK();
+
+    if (is_unused)
+        free_setup(entry);
+}
+
+
+/* **************************************************************************** */
+/* DECODER                                                                      */
+/* **************************************************************************** */
 
 
 void free_vorbis_custom(void* priv_data) {
@@ -21,6 +256,7 @@ void free_vorbis_custom(void* priv_data) {
     vorbis_dsp_clear(&data->vd);
     vorbis_comment_clear(&data->vc);
     vorbis_info_clear(&data->vi);
+    setup_cache_release(data->setup);
 
     free(data->buffer);
     free(data->fbuf);
@@ -39,6 +275,7 @@ void free_vorbis_custom(void* priv_data) {
  */
 vorbis_custom_codec_data* init_vorbis_custom(STREAMFILE* sf, off_t start_offset, vorbis_custom_t type, vorbis_custom_config* config) {
     vorbis_custom_codec_data* data = NULL;
+    vorbis_info* vi;
     int ok;
 
     /* init stuff */
@@ -79,9 +316,12 @@ vorbis_custom_codec_data* init_vorbis_custom(STREAMFILE* sf, off_t start_offset,
     data->op.b_o_s = 0; /* end of fake headers */
 
     /* init vorbis global and block state */
-    if (vorbis_synthesis_init(&data->vd,&data->vi) != 0) goto fail;
+    vi = get_setup_info(data);
+    if (vorbis_synthesis_init(&data->vd,vi) != 0) goto fail;
     if (vorbis_block_init(&data->vd,&data->vb) != 0) goto fail;
 
+    setup_cache_add(data->setup);
+
 
     /* write output */
     config->channels = data->config.channels;
@@ -173,8 +413,8 @@ static int copy_samples(VGMSTREAM* v) {
     if (samples == 0)
         return 0;
 
-    // vorbis's planar buffer to interleaved buffer
-    sbuf_init_flt(&ds->sbuf, data->fbuf, samples, v->channels);
+    // vorbis's planar buffer to our planar buffer (copied to the final buf later)
+    sbuf_init_planar(&ds->sbuf, SFMT_FLT, data->fbuf, samples, v->channels, samples);
     ds->sbuf.filled = samples;
     sbuf_interleave(&ds->sbuf, pcm);
 
@@ -252,7 +492,7 @@ int32_t vorbis_custom_get_samples(VGMSTREAM* v) {
             break;
 
         // get blocksize (somewhat similar to samples-per-frame, but must be adjusted)
-        int blocksize = vorbis_packet_blocksize(&data->vi, &data->op);
+        int blocksize = vorbis_packet_blocksize(data->vd.vi, &data->op);
         if (prev_blocksize)
             samples += (prev_blocksize + blocksize) / 4;
         prev_blocksize = blocksize;
@@ -10,6 +10,8 @@
 
 #define MAX_PACKET_SIZES 160 // max 256 in theory, observed max is ~65, rarely ~130 in 
 
+typedef struct vorbis_setup_t vorbis_setup_t;
+
 /* custom Vorbis without Ogg layer */
 struct vorbis_custom_codec_data {
     vorbis_info vi;             /* stream settings */
@@ -27,6 +29,8 @@ struct vorbis_custom_codec_data {
     vorbis_custom_t type;        /* Vorbis subtype */
     vorbis_custom_config config; /* config depending on the mode */
 
+    vorbis_setup_t* setup;      /* shared setup from cache (if set, vi is unused) */
+
 
     /* Wwise Vorbis: saved data to reconstruct modified packets */
     uint8_t mode_blockflag[64+1];   /* max 6b+1; flags 'n stuff */
@@ -61,6 +65,10 @@ int vorbis_custom_parse_packet_vid1(VGMSTREAMCHANNEL* stream, vorbis_custom_code
 int vorbis_custom_parse_packet_awc(VGMSTREAMCHANNEL* stream, vorbis_custom_codec_data* data);
 int vorbis_custom_parse_packet_oor(VGMSTREAMCHANNEL* stream, vorbis_custom_codec_data* data);
 
+/* Parsed setups (with built codebooks) are cached between streams. Returns true and sets up
+ * data if found, otherwise caller must parse the setup as usual (saved on init). */
+bool vorbis_custom_setup_cache_load(vorbis_custom_codec_data* data, const uint8_t* setup, size_t setup_size);
+
 /* other utils to make/parse vorbis stuff */
 int build_header_comment(uint8_t* buf, int bufsize);
 int build_header_identification(uint8_t* buf, int bufsize, vorbis_custom_config* cfg);
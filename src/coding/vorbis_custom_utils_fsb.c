@@ -33,6 +33,10 @@ int vorbis_custom_setup_init_fsb(STREAMFILE* sf, off_t start_offset, vorbis_cust
     cfg->blocksize_0_exp = vorbis_get_blocksize_exp(2048); //long
     cfg->blocksize_1_exp = vorbis_get_blocksize_exp(256); //short
 
+    // setup_id (a CRC of the setup) + config is enough to identify it
+    if (vorbis_custom_setup_cache_load(data, NULL, 0))
+        return 1;
+
     data->op.bytes = build_header_identification(data->buffer, data->buffer_size, cfg);
     if (vorbis_synthesis_headerin(&data->vi, &data->vc, &data->op) != 0) /* identification packet */
         goto fail;
@@ -77,6 +77,12 @@ int vorbis_custom_setup_init_wwise(STREAMFILE* sf, off_t start_offset, vorbis_cu
         offset += wp.header_size + wp.packet_size;
     }
     else {
+        /* try cache first using the original setup packet, as rebuilding + parsing it is slow */
+        ok = read_packet(&wp, data->buffer, data->buffer_size, sf, start_offset, data, 1);
+        if (!ok) goto fail;
+        if (vorbis_custom_setup_cache_load(data, data->buffer, wp.packet_size))
+            return 1;
+
         /* rebuild headers */
 
         data->op.bytes = build_header_identification(data->buffer, data->buffer_size, &data->config);
@@ -252,49 +258,8 @@ fail:
 
 /* copy packet bytes, where input/output bufs may not be byte-aligned (so no memcpy) */
 static int copy_bytes(bitstream_t* ob, bitstream_t* ib, uint32_t bytes) {
-    int i;
-
-#if 0
-    /* in theory this would be faster, but not clear results; maybe default is just optimized by compiler */
-    for (i = 0; i < bytes / 4; i++) {
-        uint32_t c = 0;
-
-        bl_get(ib, 32, &c);
-        bl_put(ob, 32,  c);
-    }
-    for (i = 0; i < bytes % 4; i++) {
-        uint32_t c = 0;
-
-        bl_get(ib,  8, &c);
-        bl_put(ob,  8,  c);
-    }
-#endif
-
-#if 0
-    /* output bits are never(?) byte aligned but input always is, yet this doesn't seem any faster */
-    if (ib->b_off % 8 == 0) {
-        int iw_pos = ib->b_off / 8;
-
-        for (i = 0; i < bytes; i++, iw_pos++) {
-            uint32_t c = ib->buf[iw_pos];
-
-          //bl_get(ib,  8, &c);
-            bl_put(ob,  8,  c);
-        }
-
-        ib->b_off += bytes * 8;
-        return 1;
-    }
-#endif
-
-    for (i = 0; i < bytes; i++) {
-        uint32_t c = 0;
-
-        bl_get(ib,  8, &c);
-        bl_put(ob,  8,  c);
-    }
-
-    return 1;
+    /* input is usually aligned but output isn't, so this copies words and shifts them into place */
+    return bl_copy(ob, ib, bytes * 8);
 }
 
 /* **************************************************************************** */
@@ -1534,6 +1534,8 @@ static const char* get_layout_name(layout_t layout_type) {
 
 static bool has_sublayouts(VGMSTREAM** vgmstreams, int count) {
     for (int i = 0; i < count; i++) {
+        if (!vgmstreams[i]) /* closed lazy segment (can't be a sublayout) */
+            continue;
         if (vgmstreams[i]->layout_type == layout_segmented || vgmstreams[i]->layout_type == layout_layered)
             return true;
     }
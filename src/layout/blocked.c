@@ -5,38 +5,36 @@
 #include "../coding/coding.h"
 
 
-/* Decodes samples for blocked streams.
- * Data is divided into headered blocks with a bunch of data. The layout calls external helper functions
- * when a block is decoded, and those must parse the new block and move offsets accordingly. */
-void render_vgmstream_blocked(sbuf_t* sdst, VGMSTREAM* vgmstream) {
-
+static int32_t get_block_samples(VGMSTREAM* vgmstream) {
     int frame_size = decode_get_frame_size(vgmstream);
     int samples_per_frame = decode_get_samples_per_frame(vgmstream);
-    int samples_this_block = 0;
 
     if (vgmstream->current_block_samples) {
-        samples_this_block = vgmstream->current_block_samples;
+        return vgmstream->current_block_samples;
     }
     else if (frame_size == 0) {
         //TO-DO: this case doesn't seem possible, codecs that return frame_size 0 (should) set current_block_samples
-        samples_this_block = vgmstream->current_block_size * 2 * samples_per_frame;
+        return vgmstream->current_block_size * 2 * samples_per_frame;
     }
     else {
-        samples_this_block = vgmstream->current_block_size / frame_size * samples_per_frame;
+        return vgmstream->current_block_size / frame_size * samples_per_frame;
     }
+}
+
+/* Decodes samples for blocked streams.
+ * Data is divided into headered blocks with a bunch of data. The layout calls external helper functions
+ * when a block is decoded, and those must parse the new block and move offsets accordingly. */
+void render_vgmstream_blocked(sbuf_t* sdst, VGMSTREAM* vgmstream) {
+
+    int samples_per_frame = decode_get_samples_per_frame(vgmstream);
+    int samples_this_block = get_block_samples(vgmstream);
 
     while (sdst->filled < sdst->samples) {
         int samples_to_do; 
 
         if (vgmstream->loop_flag && decode_do_loop(vgmstream)) {
             /* handle looping, readjust back to loop start values */
-            if (vgmstream->current_block_samples) {
-                samples_this_block = vgmstream->current_block_samples;
-            } else if (frame_size == 0) { /* assume 4 bit */
-                samples_this_block = vgmstream->current_block_size * 2 * samples_per_frame;
-            } else {
-                samples_this_block = vgmstream->current_block_size / frame_size * samples_per_frame;
-            }
+            samples_this_block = get_block_samples(vgmstream);
             continue;
         }
 
@@ -72,18 +70,8 @@ void render_vgmstream_blocked(sbuf_t* sdst, VGMSTREAM* vgmstream) {
             block_update(vgmstream->next_block_offset, vgmstream);
 
             /* update since these may change each block */
-            frame_size = decode_get_frame_size(vgmstream);
             samples_per_frame = decode_get_samples_per_frame(vgmstream);
-            if (vgmstream->current_block_samples) {
-                samples_this_block = vgmstream->current_block_samples;
-            }
-            else if (frame_size == 0) {
-                //TO-DO: this case doesn't seem possible, codecs that return frame_size 0 (should) set current_block_samples
-                samples_this_block = vgmstream->current_block_size * 2 * samples_per_frame;
-            }
-            else {
-                samples_this_block = vgmstream->current_block_size / frame_size * samples_per_frame;
-            }
+            samples_this_block = get_block_samples(vgmstream);
 
             vgmstream->samples_into_block = 0;
         }
@@ -94,127 +82,334 @@ decode_fail:
     sbuf_silence_rest(sdst);
 }
 
-/* helper functions to parse new block */
-void block_update(off_t block_offset, VGMSTREAM* vgmstream) {
-    switch (vgmstream->layout_type) {
+typedef void (*block_update_t)(off_t block_offset, VGMSTREAM* vgmstream);
+
+/* also defines which layouts are "headered blocks" (NULL if not a blocked layout) */
+static block_update_t get_block_update(layout_t layout_type) {
+    switch (layout_type) {
         case layout_blocked_ast:
-            block_update_ast(block_offset,vgmstream);
-            break;
+            return block_update_ast;
         case layout_blocked_mxch:
-            block_update_mxch(block_offset,vgmstream);
-            break;
+            return block_update_mxch;
         case layout_blocked_halpst:
-            block_update_halpst(block_offset,vgmstream);
-            break;
+            return block_update_halpst;
         case layout_blocked_xa:
-            block_update_xa(block_offset,vgmstream);
-            break;
+            return block_update_xa;
         case layout_blocked_ea_schl:
-            block_update_ea_schl(block_offset,vgmstream);
-            break;
+            return block_update_ea_schl;
         case layout_blocked_ea_1snh:
-            block_update_ea_1snh(block_offset,vgmstream);
-            break;
+            return block_update_ea_1snh;
         case layout_blocked_caf:
-            block_update_caf(block_offset,vgmstream);
-            break;
+            return block_update_caf;
         case layout_blocked_wsi:
-            block_update_wsi(block_offset,vgmstream);
-            break;
+            return block_update_wsi;
         case layout_blocked_str_snds:
-            block_update_str_snds(block_offset,vgmstream);
-            break;
+            return block_update_str_snds;
         case layout_blocked_ws_aud:
-            block_update_ws_aud(block_offset,vgmstream);
-            break;
+            return block_update_ws_aud;
         case layout_blocked_dec:
-            block_update_dec(block_offset,vgmstream);
-            break;
+            return block_update_dec;
         case layout_blocked_mul:
-            block_update_mul(block_offset,vgmstream);
-            break;
+            return block_update_mul;
         case layout_blocked_gsnd:
-            block_update_gsnd(block_offset,vgmstream);
-            break;
+            return block_update_gsnd;
         case layout_blocked_vs_mh:
-            block_update_vs_mh(block_offset,vgmstream);
-            break;
+            return block_update_vs_mh;
         case layout_blocked_vas_kceo:
-            block_update_vas_kceo(block_offset,vgmstream);
-            break;
+            return block_update_vas_kceo;
         case layout_blocked_thp:
-            block_update_thp(block_offset,vgmstream);
-            break;
+            return block_update_thp;
         case layout_blocked_filp:
-            block_update_filp(block_offset,vgmstream);
-            break;
+            return block_update_filp;
         case layout_blocked_rage_aud:
-            block_update_rage_aud(block_offset,vgmstream);
-            break;
+            return block_update_rage_aud;
         case layout_blocked_ea_swvr:
-            block_update_ea_swvr(block_offset,vgmstream);
-            break;
+            return block_update_ea_swvr;
         case layout_blocked_adm:
-            block_update_adm(block_offset,vgmstream);
-            break;
+            return block_update_adm;
         case layout_blocked_ps2_iab:
-            block_update_ps2_iab(block_offset,vgmstream);
-            break;
+            return block_update_ps2_iab;
         case layout_blocked_vs_str:
-            block_update_vs_str(block_offset,vgmstream);
-            break;
+            return block_update_vs_str;
         case layout_blocked_rws:
-            block_update_rws(block_offset,vgmstream);
-            break;
+            return block_update_rws;
         case layout_blocked_hwas:
-            block_update_hwas(block_offset,vgmstream);
-            break;
+            return block_update_hwas;
         case layout_blocked_ea_sns:
-            block_update_ea_sns(block_offset,vgmstream);
-            break;
+            return block_update_ea_sns;
         case layout_blocked_awc:
-            block_update_awc(block_offset,vgmstream);
-            break;
+            return block_update_awc;
         case layout_blocked_vgs:
-            block_update_vgs(block_offset,vgmstream);
-            break;
+            return block_update_vgs;
         case layout_blocked_xwav:
-            block_update_xwav(block_offset,vgmstream);
-            break;
+            return block_update_xwav;
         case layout_blocked_xvag_subsong:
-            block_update_xvag_subsong(block_offset,vgmstream);
-            break;
+            return block_update_xvag_subsong;
         case layout_blocked_ea_wve_au00:
-            block_update_ea_wve_au00(block_offset,vgmstream);
-            break;
+            return block_update_ea_wve_au00;
         case layout_blocked_ea_wve_ad10:
-            block_update_ea_wve_ad10(block_offset,vgmstream);
-            break;
+            return block_update_ea_wve_ad10;
         case layout_blocked_sthd:
-            block_update_sthd(block_offset,vgmstream);
-            break;
+            return block_update_sthd;
         case layout_blocked_h4m:
-            block_update_h4m(block_offset,vgmstream);
-            break;
+            return block_update_h4m;
         case layout_blocked_xa_aiff:
-            block_update_xa_aiff(block_offset,vgmstream);
-            break;
+            return block_update_xa_aiff;
         case layout_blocked_vs_square:
-            block_update_vs_square(block_offset,vgmstream);
-            break;
+            return block_update_vs_square;
         case layout_blocked_vid1:
-            block_update_vid1(block_offset,vgmstream);
-            break;
+            return block_update_vid1;
         case layout_blocked_ubi_sce:
-            block_update_ubi_sce(block_offset,vgmstream);
-            break;
+            return block_update_ubi_sce;
         case layout_blocked_tt_ad:
-            block_update_tt_ad(block_offset,vgmstream);
-            break;
+            return block_update_tt_ad;
         case layout_blocked_vas:
-            block_update_vas(block_offset,vgmstream);
-            break;
+            return block_update_vas;
         default: /* not a blocked layout */
+            return NULL;
+    }
+}
+
+/* helper functions to parse new block */
+void block_update(off_t block_offset, VGMSTREAM* vgmstream) {
+    block_update_t update = get_block_update(vgmstream->layout_type);
+    if (update)
+        update(block_offset, vgmstream);
+}
+
+
+/* Seek index: offset and start sample of each block, so seeking can jump to the target block instead of decoding
+ * from the beginning. Made by walking block headers without decoding (when counting samples on open, or on first
+ * seek otherwise), using the same block samples that decoding will use.
+ *
+ * Jumping is only possible if decoding a block from its start is the same as reaching it by decoding: blocks
+ * must not depend on state left by previous blocks (ex. ADPCM history), and block_update may only rely on
+ * full_block_size from previous blocks (saved per block). */
+
+#define BLOCKED_INDEX_MIN 256
+
+typedef struct {
+    off_t offset;           /* passed to block_update (some layouts skip padding blocks) */
+    size_t full_block_size; /* before block_update */
+    int32_t sample;
+} blocked_entry_t;
+
+typedef struct {
+    blocked_entry_t* entries;
+    int count;
+    int capacity;
+    int32_t samples;        /* after last block */
+    bool done;              /* no more blocks can be added */
+} blocked_index_t;
+
+
+static bool is_layout_blocked(VGMSTREAM* vgmstream) {
+    return get_block_update(vgmstream->layout_type) != NULL;
+}
+
+static bool is_index_seekable(VGMSTREAM* vgmstream) {
+    if (!is_layout_blocked(vgmstream) || vgmstream->codec_data)
+        return false;
+
+    /* DSP history is reset every block */
+    if (vgmstream->layout_type == layout_blocked_thp)
+        return true;
+
+    switch (vgmstream->coding_type) {
+        case coding_PCM16LE:
+        case coding_PCM16BE:
+        case coding_PCM16_int:
+        case coding_PCM8:
+        case coding_PCM8_int:
+        case coding_PCM8_U:
+        case coding_PCM8_U_int:
+        case coding_PCM8_SB:
+        case coding_PCM4:
+        case coding_PCM4_U:
+        case coding_ULAW:
+        case coding_ULAW_int:
+        case coding_ALAW:
+        case coding_PCMFLOAT:
+        case coding_PCM24LE:
+        case coding_PCM24BE:
+        case coding_PCM32LE:
+        /* frames have their own header */
+        case coding_MS_IMA:
+        case coding_MS_IMA_mono:
+        case coding_XBOX_IMA:
+        case coding_XBOX_IMA_mch:
+        case coding_XBOX_IMA_mono:
+        case coding_MSADPCM:
+        case coding_MSADPCM_mono:
+        case coding_MSADPCM_ck:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void index_add(blocked_index_t* index, off_t block_offset, size_t full_block_size, int32_t block_samples) {
+    if (index->done)
+        return;
+
+    if (block_samples < 0) {
+        index->done = true;
+        return;
+    }
+    if (block_samples == 0)
+        return;
+
+    if (index->count >= index->capacity) {
+        int capacity = index->capacity ? index->capacity * 2 : BLOCKED_INDEX_MIN;
+        blocked_entry_t* entries = realloc(index->entries, capacity * sizeof(blocked_entry_t));
+        if (!entries) {
+            index->done = true;
+            return;
+        }
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+
+    blocked_entry_t* entry = &index->entries[index->count];
+    entry->offset = block_offset;
+    entry->full_block_size = full_block_size;
+    entry->sample = index->samples;
+    index->count++;
+    index->samples += block_samples;
+}
+
+static blocked_index_t* index_init(VGMSTREAM* vgmstream) {
+    blocked_index_t* index = calloc(1, sizeof(blocked_index_t));
+    if (!index) return NULL;
+
+    /* shared so resets keep it */
+    vgmstream->block_index = index;
+    if (vgmstream->start_vgmstream)
+        ((VGMSTREAM*)vgmstream->start_vgmstream)->block_index = index;
+    return index;
+}
+
+void blocked_index_free(VGMSTREAM* vgmstream) {
+    blocked_index_t* index = vgmstream->block_index;
+    if (!index)
+        return;
+
+    free(index->entries);
+    free(index);
+
+    vgmstream->block_index = NULL;
+    if (vgmstream->start_vgmstream)
+        ((VGMSTREAM*)vgmstream->start_vgmstream)->block_index = NULL;
+}
+
+/* same as block_update, but also adds the block to the seek index (must be called for each block in order) */
+void block_update_indexed(off_t block_offset, VGMSTREAM* vgmstream) {
+    size_t full_block_size = vgmstream->full_block_size;
+
+    block_update(block_offset, vgmstream);
+
+    blocked_index_t* index = vgmstream->block_index;
+    if (!index) {
+        if (!is_index_seekable(vgmstream))
+            return;
+        index = index_init(vgmstream);
+        if (!index) return;
+    }
+
+    index_add(index, block_offset, full_block_size, get_block_samples(vgmstream));
+}
+
+/* walks all block headers from the start, restoring current state after */
+static void build_index(VGMSTREAM* vgmstream) {
+    VGMSTREAM* backup = NULL;
+    VGMSTREAM* start = vgmstream->start_vgmstream;
+    VGMSTREAMCHANNEL* backup_ch = NULL;
+
+    blocked_index_t* index = index_init(vgmstream);
+    if (!index) return;
+    index->done = true; /* in case of errors below */
+
+    backup = malloc(sizeof(VGMSTREAM));
+    backup_ch = malloc(vgmstream->channels * sizeof(VGMSTREAMCHANNEL));
+    if (!backup || !backup_ch) goto end;
+    memcpy(backup, vgmstream, sizeof(VGMSTREAM));
+    memcpy(backup_ch, vgmstream->ch, vgmstream->channels * sizeof(VGMSTREAMCHANNEL));
+
+    /* same as reset (first block is already set and never jumped to, since seeks are forward only) */
+    memcpy(vgmstream, start, sizeof(VGMSTREAM));
+    memcpy(vgmstream->ch, vgmstream->start_ch, vgmstream->channels * sizeof(VGMSTREAMCHANNEL));
+
+    off_t max_offset = get_streamfile_size(vgmstream->ch[0].streamfile);
+
+    index->done = false;
+    index_add(index, vgmstream->current_block_offset, vgmstream->full_block_size, get_block_samples(vgmstream));
+    while (!index->done && index->samples < vgmstream->num_samples) {
+        off_t block_offset = vgmstream->next_block_offset;
+        if (block_offset >= max_offset || block_offset <= vgmstream->current_block_offset)
             break;
+        block_update_indexed(block_offset, vgmstream);
     }
+    index->done = true;
+
+    memcpy(vgmstream, backup, sizeof(VGMSTREAM));
+    memcpy(vgmstream->ch, backup_ch, vgmstream->channels * sizeof(VGMSTREAMCHANNEL));
+    vgmstream->block_index = index;
+end:
+    free(backup);
+    free(backup_ch);
+}
+
+/* binary search of the last block that starts at or before sample */
+static int find_entry(blocked_index_t* index, int32_t sample) {
+    if (index->count <= 0 || sample < index->entries[0].sample)
+        return -1;
+
+    int lo = 0;
+    int hi = index->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (index->entries[mid].sample <= sample)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+/* Moves to the block that contains seek_sample if it's ahead of current position. Caller must decode
+ * from the new current_sample to seek_sample. */
+void seek_layout_blocked(VGMSTREAM* vgmstream, int32_t seek_sample) {
+    if (!is_index_seekable(vgmstream))
+        return;
+
+    /* don't go past loop points, as the loop state must be saved/restored when reaching them */
+    int32_t max_sample = seek_sample;
+    if (vgmstream->loop_flag) {
+        int32_t loop_sample = vgmstream->hit_loop ? vgmstream->loop_end_sample : vgmstream->loop_start_sample;
+        if (max_sample > loop_sample)
+            max_sample = loop_sample;
+    }
+
+    /* not worth it if target is in current block */
+    if (max_sample - vgmstream->current_sample < get_block_samples(vgmstream) - vgmstream->samples_into_block)
+        return;
+
+    if (!vgmstream->block_index)
+        build_index(vgmstream);
+    blocked_index_t* index = vgmstream->block_index;
+    if (!index)
+        return;
+
+    int pos = find_entry(index, max_sample);
+    if (pos < 0)
+        return;
+
+    blocked_entry_t* entry = &index->entries[pos];
+    if (entry->sample <= vgmstream->current_sample)
+        return;
+
+    vgmstream->full_block_size = entry->full_block_size;
+    block_update(entry->offset, vgmstream);
+    vgmstream->current_sample = entry->sample;
+    vgmstream->samples_into_block = 0;
 }
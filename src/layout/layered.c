@@ -21,6 +21,14 @@ void render_vgmstream_layered(sbuf_t* sdst, VGMSTREAM* vgmstream) {
     int samples_per_frame = VGMSTREAM_LAYER_SAMPLE_BUFFER;
     int samples_this_block = vgmstream->num_samples; /* do all samples if possible */
 
+    if (!data->buffer) {
+        data->buffer = malloc(data->buffer_size);
+        if (!data->buffer) {
+            VGM_LOG_ONCE("LAYERED: can't allocate buffer\n");
+            goto decode_fail;
+        }
+    }
+
     //int samples_filled = 0;
     while (sdst->filled < sdst->samples) {
         int ch;
@@ -185,17 +193,15 @@ bool setup_layout_layered(layered_layout_data* data) {
     if (max_output_channels > VGMSTREAM_MAX_CHANNELS || max_input_channels > VGMSTREAM_MAX_CHANNELS)
         return false;
 
-    /* create internal buffer big enough for mixing all layers */
+    /* internal buffer big enough for mixing all layers (created on first render) */
     free(data->buffer);
-    data->buffer = malloc(VGMSTREAM_LAYER_SAMPLE_BUFFER * max_input_channels * max_sample_size);
-    if (!data->buffer) goto fail;
+    data->buffer = NULL;
+    data->buffer_size = VGMSTREAM_LAYER_SAMPLE_BUFFER * max_input_channels * max_sample_size;
 
     data->input_channels = max_input_channels;
     data->output_channels = max_output_channels;
 
     return true;
-fail:
-    return false; /* caller is expected to free */
 }
 
 void free_layout_layered(layered_layout_data* data) {
@@ -15,19 +15,44 @@ void render_vgmstream_interleave(sbuf_t* sbuf, VGMSTREAM* vgmstream);
 
 /* segmented layout */
 /* for files made of "continuous" segments, one per section of a song (using a complete sub-VGMSTREAM) */
+typedef VGMSTREAM* (*segmented_open_t)(void* priv, int segment);
+
+/* segment values used by the layout, saved in lazy mode so closed segments don't need to be opened */
+typedef struct {
+    int32_t samples;        /* play samples */
+    int input_channels;
+    int output_channels;
+    int sample_size;        /* input sample size */
+    int sample_rate;
+    uint32_t channel_layout;
+    coding_t coding_type;
+    meta_t meta_type;
+} segment_info_t;
+
 typedef struct {
     int segment_count;
     VGMSTREAM** segments;
     int current_segment;
-    sample_t* buffer;
+    sample_t* buffer;       /* allocated on first render */
+    size_t buffer_size;
     int input_channels;     /* internal buffer channels */
     int output_channels;    /* resulting channels (after mixing, if applied) */
     bool mixed_channels;     /* segments have different number of channels */
+
+    /* lazy mode: only a few segments are kept open (others are NULL and reopened when needed) */
+    segmented_open_t open_segment;
+    void (*free_priv)(void* priv);
+    void* open_priv;
+    segment_info_t* segment_info; /* per segment, since closed segments can't be queried */
+    int32_t* segment_starts; /* first sample of each segment + total end (segment_count + 1), for seeking */
+    int loop_segment;       /* kept open (-1 if not looped) */
 } segmented_layout_data;
 
 void render_vgmstream_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream);
 segmented_layout_data* init_layout_segmented(int segment_count);
 bool setup_layout_segmented(segmented_layout_data* data);
+void get_segment_info(VGMSTREAM* segment, int index, segment_info_t* info);
+bool setup_layout_segmented_lazy(segmented_layout_data* data, const segment_info_t* info, int loop_segment, segmented_open_t open_segment, void (*free_priv)(void* priv), void* priv);
 void free_layout_segmented(segmented_layout_data* data);
 void reset_layout_segmented(segmented_layout_data* data);
 void seek_layout_segmented(VGMSTREAM* vgmstream, int32_t seek_sample);
@@ -39,7 +64,8 @@ void loop_layout_segmented(VGMSTREAM* vgmstream, int32_t loop_sample);
 typedef struct {
     int layer_count;
     VGMSTREAM** layers;
-    void* buffer;
+    void* buffer;           /* allocated on first render */
+    size_t buffer_size;
     int input_channels;     /* internal buffer channels */
     int output_channels;    /* resulting channels (after mixing, if applied) */
     int external_looping;   /* don't loop using per-layer loops, but layout's own looping */
@@ -58,6 +84,9 @@ void loop_layout_layered(VGMSTREAM* vgmstream, int32_t loop_sample);
 /* blocked layouts */
 void render_vgmstream_blocked(sbuf_t* sbuf, VGMSTREAM* vgmstream);
 void block_update(off_t block_offset, VGMSTREAM* vgmstream);
+void block_update_indexed(off_t block_offset, VGMSTREAM* vgmstream);
+void seek_layout_blocked(VGMSTREAM* vgmstream, int32_t seek_sample);
+void blocked_index_free(VGMSTREAM* vgmstream);
 
 void block_update_ast(off_t block_ofset, VGMSTREAM* vgmstream);
 void block_update_mxch(off_t block_ofset, VGMSTREAM* vgmstream);
@@ -9,6 +9,10 @@
 #define VGMSTREAM_MAX_SEGMENTS 1024
 #define VGMSTREAM_SEGMENT_SAMPLE_BUFFER 8192
 
+static bool open_segment(segmented_layout_data* data, int segment);
+static void update_segments(segmented_layout_data* data, int prev_segment);
+static int find_segment(segmented_layout_data* data, int32_t sample);
+
 
 /* Decodes samples for segmented streams.
  * Chains together sequential vgmstreams, for data divided into separate sections or files
@@ -19,12 +23,21 @@ void render_vgmstream_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
     sbuf_t* ssrc = &ssrc_tmp;
 
 
-    if (data->current_segment >= data->segment_count) {
+    if (data->current_segment >= data->segment_count || !open_segment(data, data->current_segment)) {
         VGM_LOG_ONCE("SEGMENT: wrong current segment\n");
         sbuf_silence_rest(sbuf);
         return;
     }
 
+    if (!data->buffer) {
+        data->buffer = malloc(data->buffer_size);
+        if (!data->buffer) {
+            VGM_LOG_ONCE("SEGMENTED: can't allocate buffer\n");
+            sbuf_silence_rest(sbuf);
+            return;
+        }
+    }
+
     int current_channels = 0;
     mixing_info(data->segments[data->current_segment], NULL, &current_channels);
     int samples_this_block = vgmstream_get_samples(data->segments[data->current_segment]);
@@ -43,6 +56,7 @@ void render_vgmstream_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
 
         /* detect segment change and restart (after loop, but before decode, to allow looping to kick in) */
         if (vgmstream->samples_into_block >= samples_this_block) {
+            int prev_segment = data->current_segment;
             data->current_segment++;
 
             if (data->current_segment >= data->segment_count) { /* when decoding more than num_samples */
@@ -50,6 +64,10 @@ void render_vgmstream_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
                 goto decode_fail;
             }
 
+            if (!open_segment(data, data->current_segment))
+                goto decode_fail;
+            update_segments(data, prev_segment);
+
             /* in case of looping spanning multiple segments */
             reset_vgmstream(data->segments[data->current_segment]);
 
@@ -71,13 +89,20 @@ void render_vgmstream_segmented(sbuf_t* sbuf, VGMSTREAM* vgmstream) {
             goto decode_fail;
         }
 
-        segment_format = mixing_get_input_sample_type(data->segments[data->current_segment]);
-        sbuf_init(ssrc, segment_format, data->buffer, samples_to_do, data->segments[data->current_segment]->channels);
+        VGMSTREAM* segment = data->segments[data->current_segment];
+        segment_format = mixing_get_input_sample_type(segment);
+        sbuf_init(ssrc, segment_format, data->buffer, samples_to_do, segment->channels);
 
         // try to use part of outbuf directly if not remixed (minioptimization) //TODO improve detection
         if (vgmstream->channels == data->input_channels && sbuf->fmt == segment_format && !data->mixed_channels) {
-            buf_filled = sbuf_get_filled_buf(sbuf);
-            ssrc->buf = buf_filled;
+            if (!sbuf->planar) {
+                buf_filled = sbuf_get_filled_buf(sbuf);
+                ssrc->buf = buf_filled;
+            }
+            else if (render_supports_planar(segment)) {
+                buf_filled = sbuf_get_filled_buf(sbuf);
+                sbuf_init_planar(ssrc, segment_format, buf_filled, samples_to_do, segment->channels, sbuf->plane_size);
+            }
         }
 
         int samples_done = render_main(ssrc, data->segments[data->current_segment]);
@@ -103,33 +128,63 @@ decode_fail:
 void seek_layout_segmented(VGMSTREAM* vgmstream, int32_t seek_sample) {
     segmented_layout_data* data = vgmstream->layout_data;
 
-    int segment = 0;
-    int total_samples = 0;
-    while (total_samples < vgmstream->num_samples) {
-        int32_t segment_samples = vgmstream_get_samples(data->segments[segment]);
-
-        /* find if sample falls within segment's samples */
-        if (seek_sample >= total_samples && seek_sample < total_samples + segment_samples) {
-            int32_t seek_relative = seek_sample - total_samples;
-
-            seek_vgmstream(data->segments[segment], seek_relative);
-            data->current_segment = segment;
-            vgmstream->samples_into_block = seek_relative;
-            break;
-        }
-
-        total_samples += segment_samples;
-        segment++;
+    /* find segment where sample falls within segment's samples */
+    int segment = find_segment(data, seek_sample);
+    if (segment < 0 || seek_sample >= vgmstream->num_samples) {
+        VGM_LOG("SEGMENTED: can't find seek segment\n");
+        return;
     }
 
-    // ???
-    VGM_ASSERT(segment == data->segment_count, "SEGMENTED: can't find seek segment\n");
+    int32_t seek_relative = seek_sample - data->segment_starts[segment];
+    int prev_segment = data->current_segment;
+
+    data->current_segment = segment;
+    vgmstream->samples_into_block = seek_relative;
+    if (!open_segment(data, segment))
+        return; /* render will output silence */
+    seek_vgmstream(data->segments[segment], seek_relative);
+    update_segments(data, prev_segment);
 }
 
 void loop_layout_segmented(VGMSTREAM* vgmstream, int32_t loop_sample) {
+    segmented_layout_data* data = vgmstream->layout_data;
+
     seek_layout_segmented(vgmstream, loop_sample);
+
+    /* keep loop start open in lazy mode, as it's going to be needed again */
+    if (data->open_segment && data->loop_segment != data->current_segment) {
+        int prev_loop_segment = data->loop_segment;
+        data->loop_segment = data->current_segment;
+        update_segments(data, prev_loop_segment);
+    }
+}
+
+
+static void setup_segment_config(VGMSTREAM* segment, int index) {
+    /* allow config if set for fine-tuned parts (usually TXTP only) */
+    segment->config_enabled = segment->config.config_set;
+
+    /* disable so that looping is controlled by render_vgmstream_segmented */
+    if (segment->loop_flag != 0) {
+        VGM_LOG("SEGMENTED: segment %i is looped\n", index);
+
+        /* config allows internal loops */
+        if (!segment->config_enabled) {
+            segment->loop_flag = 0;
+        }
+    }
 }
 
+/* setups a VGMSTREAM as part of the layout (roughly equivalent to vgmstream.c's init_vgmstream_internal stuff) */
+static void setup_segment(VGMSTREAM* segment, int index) {
+    setup_segment_config(segment, index);
+
+    /* init mixing */
+    mixing_setup(segment, VGMSTREAM_SEGMENT_SAMPLE_BUFFER);
+
+    /* final setup in case the VGMSTREAM was created manually */
+    setup_vgmstream(segment);
+}
 
 segmented_layout_data* init_layout_segmented(int segment_count) {
     segmented_layout_data* data = NULL;
@@ -145,6 +200,7 @@ segmented_layout_data* init_layout_segmented(int segment_count) {
 
     data->segment_count = segment_count;
     data->current_segment = 0;
+    data->loop_segment = -1;
 
     return data;
 fail:
@@ -152,92 +208,90 @@ fail:
     return NULL;
 }
 
-bool setup_layout_segmented(segmented_layout_data* data) {
+/* sets layout values from each segment's info (segments may be closed in lazy mode) */
+static bool setup_layout_info(segmented_layout_data* data) {
+    const segment_info_t* info = data->segment_info;
     int max_input_channels = 0;
     int max_output_channels = 0;
     int max_sample_size = 0;
     bool mixed_channels = false;
 
-    /* setup each VGMSTREAM (roughly equivalent to vgmstream.c's init_vgmstream_internal stuff) */
     for (int i = 0; i < data->segment_count; i++) {
-
-        if (data->segments[i] == NULL) {
-            VGM_LOG("SEGMENTED: no vgmstream in segment %i\n", i);
-            return false;
-        }
-
-        if (data->segments[i]->num_samples <= 0) {
-            VGM_LOG("SEGMENTED: no samples in segment %i\n", i);
-            return false;
-        }
-
-        /* allow config if set for fine-tuned parts (usually TXTP only) */
-        data->segments[i]->config_enabled = data->segments[i]->config.config_set;
-
-        /* disable so that looping is controlled by render_vgmstream_segmented */
-        if (data->segments[i]->loop_flag != 0) {
-            VGM_LOG("SEGMENTED: segment %i is looped\n", i);
-
-            /* config allows internal loops */
-            if (!data->segments[i]->config_enabled) {
-                data->segments[i]->loop_flag = 0;
-            }
-        }
-
         /* different segments may have different input or output channels (in rare cases of using ex. 2ch + 4ch) */
-        int segment_input_channels, segment_output_channels;
-        mixing_info(data->segments[i], &segment_input_channels, &segment_output_channels);
-        if (max_input_channels < segment_input_channels)
-            max_input_channels = segment_input_channels;
-        if (max_output_channels < segment_output_channels)
-            max_output_channels = segment_output_channels;
+        if (max_input_channels < info[i].input_channels)
+            max_input_channels = info[i].input_channels;
+        if (max_output_channels < info[i].output_channels)
+            max_output_channels = info[i].output_channels;
 
         if (i > 0) {
-            int prev_output_channels;
-
-            mixing_info(data->segments[i-1], NULL, &prev_output_channels);
-            if (segment_output_channels != prev_output_channels) {
+            if (info[i].output_channels != info[i-1].output_channels) {
                 mixed_channels = true;
-                //VGM_LOG("SEGMENTED: segment %i has wrong channels %i vs prev channels %i\n", i, segment_output_channels, prev_output_channels);
+                //VGM_LOG("SEGMENTED: segment %i has wrong channels %i vs prev channels %i\n", i, info[i].output_channels, info[i-1].output_channels);
                 //goto fail;
             }
 
             /* a bit weird, but no matter (should resample) */
-            if (data->segments[i]->sample_rate != data->segments[i-1]->sample_rate) {
+            if (info[i].sample_rate != info[i-1].sample_rate) {
                 VGM_LOG("SEGMENTED: segment %i has different sample rate\n", i);
             }
 
             /* perfectly acceptable */
-            //if (data->segments[i]->coding_type != data->segments[i-1]->coding_type)
+            //if (info[i].coding_type != info[i-1].coding_type)
             //    goto fail;
         }
 
-        int current_sample_size = sfmt_get_sample_size( mixing_get_input_sample_type(data->segments[i]) );
-        if (max_sample_size < current_sample_size)
-            max_sample_size = current_sample_size;
-
-        /* init mixing */
-        mixing_setup(data->segments[i], VGMSTREAM_SEGMENT_SAMPLE_BUFFER);
-
-        /* final setup in case the VGMSTREAM was created manually */
-        setup_vgmstream(data->segments[i]);
+        if (max_sample_size < info[i].sample_size)
+            max_sample_size = info[i].sample_size;
     }
 
     if (max_output_channels > VGMSTREAM_MAX_CHANNELS || max_input_channels > VGMSTREAM_MAX_CHANNELS)
         return false;
 
-    /* create internal buffer big enough for mixing */
+    /* internal buffer big enough for mixing (created on first render) */
     free(data->buffer);
-    data->buffer = malloc(VGMSTREAM_SEGMENT_SAMPLE_BUFFER * max_input_channels * max_sample_size);
-    if (!data->buffer) goto fail;
+    data->buffer = NULL;
+    data->buffer_size = VGMSTREAM_SEGMENT_SAMPLE_BUFFER * max_input_channels * max_sample_size;
+
+    /* precalc segment positions so seeking doesn't need to walk all segments */
+    free(data->segment_starts);
+    data->segment_starts = malloc((data->segment_count + 1) * sizeof(int32_t));
+    if (!data->segment_starts) return false;
+
+    data->segment_starts[0] = 0;
+    for (int i = 0; i < data->segment_count; i++) {
+        data->segment_starts[i + 1] = data->segment_starts[i] + info[i].samples;
+    }
 
     data->input_channels = max_input_channels;
     data->output_channels = max_output_channels;
     data->mixed_channels = mixed_channels;
 
     return true;
-fail:
-    return false; /* caller is expected to free */
+}
+
+bool setup_layout_segmented(segmented_layout_data* data) {
+
+    free(data->segment_info);
+    data->segment_info = malloc(data->segment_count * sizeof(segment_info_t));
+    if (!data->segment_info) return false;
+
+    /* setup each VGMSTREAM */
+    for (int i = 0; i < data->segment_count; i++) {
+
+        if (data->segments[i] == NULL) {
+            VGM_LOG("SEGMENTED: no vgmstream in segment %i\n", i);
+            return false;
+        }
+
+        if (data->segments[i]->num_samples <= 0) {
+            VGM_LOG("SEGMENTED: no samples in segment %i\n", i);
+            return false;
+        }
+
+        get_segment_info(data->segments[i], i, &data->segment_info[i]);
+    }
+
+    return setup_layout_info(data); /* caller is expected to free on failure */
 }
 
 void free_layout_segmented(segmented_layout_data* data) {
@@ -261,6 +315,10 @@ void free_layout_segmented(segmented_layout_data* data) {
     }
     free(data->segments);
     free(data->buffer);
+    free(data->segment_info);
+    free(data->segment_starts);
+    if (data->free_priv)
+        data->free_priv(data->open_priv);
     free(data);
 }
 
@@ -269,8 +327,155 @@ void reset_layout_segmented(segmented_layout_data* data) {
         return;
 
     for (int i = 0; i < data->segment_count; i++) {
+        if (!data->segments[i])
+            continue;
         reset_vgmstream(data->segments[i]);
     }
 
+    int prev_segment = data->current_segment;
     data->current_segment = 0;
+    update_segments(data, prev_segment);
+}
+
+
+/* Lazy mode: segments other than the current one, next (prefetched), first and loop start are closed,
+ * then reopened from the callback when reached. Layout values come from each segment's info, probed
+ * beforehand, so segments don't need to be open during setup either. Reopened segments are setup the same
+ * as the original ones. Since closed segments can't be queried it's only allowed for segments without
+ * repeats or sublayouts. */
+
+static int32_t get_segment_samples(segmented_layout_data* data, int segment) {
+    return data->segment_starts[segment + 1] - data->segment_starts[segment];
+}
+
+/* binary search of the segment that contains sample (segments always have samples) */
+static int find_segment(segmented_layout_data* data, int32_t sample) {
+    if (!data->segment_starts || sample < 0 || sample >= data->segment_starts[data->segment_count])
+        return -1;
+
+    int lo = 0;
+    int hi = data->segment_count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (data->segment_starts[mid] <= sample)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+static bool is_segment_pinned(segmented_layout_data* data, int segment) {
+    return segment == 0
+        || segment == data->current_segment
+        || segment == data->current_segment + 1
+        || segment == data->loop_segment;
+}
+
+static bool open_segment(segmented_layout_data* data, int segment) {
+    if (segment < 0 || segment >= data->segment_count)
+        return false;
+    if (data->segments[segment])
+        return true;
+    if (!data->open_segment)
+        return false;
+
+    VGMSTREAM* vgmstream = data->open_segment(data->open_priv, segment);
+    if (!vgmstream) {
+        VGM_LOG("SEGMENTED: can't reopen segment %i\n", segment);
+        return false;
+    }
+
+    setup_segment(vgmstream, segment);
+    if (vgmstream_get_samples(vgmstream) != get_segment_samples(data, segment) || vgmstream->channels > data->input_channels) {
+        VGM_LOG("SEGMENTED: reopened segment %i doesn't match\n", segment);
+        close_vgmstream(vgmstream);
+        return false;
+    }
+
+    data->segments[segment] = vgmstream;
+    return true;
+}
+
+static void close_segment(segmented_layout_data* data, int segment) {
+    if (segment < 0 || segment >= data->segment_count || is_segment_pinned(data, segment))
+        return;
+    close_vgmstream(data->segments[segment]);
+    data->segments[segment] = NULL;
+}
+
+/* after current segment changes from prev: closes segments that left the window and prefetches next
+ * (only current/next/first/loop may be open, so no need to check all segments) */
+static void update_segments(segmented_layout_data* data, int prev_segment) {
+    if (!data->open_segment)
+        return;
+
+    close_segment(data, prev_segment);
+    close_segment(data, prev_segment + 1);
+
+    if (data->current_segment + 1 < data->segment_count) {
+        open_segment(data, data->current_segment + 1); /* on failure retried when reached */
+    }
+}
+
+/* setups the segment as part of a layout (done once) and gets values used by the layout */
+void get_segment_info(VGMSTREAM* segment, int index, segment_info_t* info) {
+    setup_segment(segment, index);
+
+    info->samples = vgmstream_get_samples(segment);
+    mixing_info(segment, &info->input_channels, &info->output_channels);
+    info->sample_size = sfmt_get_sample_size( mixing_get_input_sample_type(segment) );
+    info->sample_rate = segment->sample_rate;
+    info->channel_layout = segment->channel_layout;
+    info->coding_type = segment->coding_type;
+    info->meta_type = segment->meta_type;
+}
+
+/* setups a layout with no open segments from their info, then opens the first/next/loop segments */
+bool setup_layout_segmented_lazy(segmented_layout_data* data, const segment_info_t* info, int loop_segment, segmented_open_t open_segment_cb, void (*free_priv)(void* priv), void* priv) {
+
+    if (!data || !info || !open_segment_cb || data->open_segment)
+        goto fail;
+
+    /* from here on priv is freed with the layout */
+    data->open_segment = open_segment_cb;
+    data->free_priv = free_priv;
+    data->open_priv = priv;
+
+    free(data->segment_info);
+    data->segment_info = malloc(data->segment_count * sizeof(segment_info_t));
+    if (!data->segment_info) return false;
+    memcpy(data->segment_info, info, data->segment_count * sizeof(segment_info_t));
+
+    for (int i = 0; i < data->segment_count; i++) {
+        if (data->segments[i]) {
+            VGM_LOG("SEGMENTED: segment %i is open\n", i);
+            return false;
+        }
+        if (info[i].samples <= 0) {
+            VGM_LOG("SEGMENTED: no samples in segment %i\n", i);
+            return false;
+        }
+    }
+
+    if (!setup_layout_info(data))
+        return false;
+
+    /* keep loop start open from the beginning, rather than reopening it on first loop */
+    if (loop_segment >= 0 && loop_segment < data->segment_count)
+        data->loop_segment = loop_segment;
+
+    if (!open_segment(data, 0))
+        return false;
+    /* on failure retried when reached */
+    if (data->segment_count > 1)
+        open_segment(data, 1);
+    if (data->loop_segment > 0)
+        open_segment(data, data->loop_segment);
+
+    return true;
+fail:
+    if (free_priv)
+        free_priv(priv);
+    return false;
 }
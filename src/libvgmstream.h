@@ -55,7 +55,7 @@
  * - vgmstream's features are mostly stable, but this API may be tweaked from time to time
  */
 #define LIBVGMSTREAM_API_VERSION_MAJOR 0x01    // breaking API/ABI changes
-#define LIBVGMSTREAM_API_VERSION_MINOR 0x00    // compatible API/ABI changes
+#define LIBVGMSTREAM_API_VERSION_MINOR 0x01    // compatible API/ABI changes
 #define LIBVGMSTREAM_API_VERSION_PATCH 0x00    // fixes
 
 /* Current API version, for dynamic checks. returns hex value: 0xMMmmpppp = MM-major, mm-minor, pppp-patch
@@ -65,18 +65,25 @@ LIBVGMSTREAM_API uint32_t libvgmstream_get_version(void);
 
 /* CHANGELOG:
  * - 1.0.0: beta version
+ * - 1.1.0: planar sample formats, voice mixer API, format's input_sample_rate and
+ *          config's render_samples/resample_rate/resample_quality/io_buffer_size (appended to structs)
  */
 
 
 /*****************************************************************************/
 /* DECODE */
 
-/* available sample formats, interleaved: buf[0]=ch0, buf[1]=ch1, buf[2]=ch0, buf[3]=ch0, ... */
+/* available sample formats, interleaved: buf[0]=ch0, buf[1]=ch1, buf[2]=ch0, buf[3]=ch0, ...
+ * or planar (*P): buf[0..N-1]=ch0, buf[N..N*2-1]=ch1, ... where N is buf's samples */
 typedef enum {
     LIBVGMSTREAM_SFMT_PCM16 = 1,
     LIBVGMSTREAM_SFMT_PCM24 = 2,
     LIBVGMSTREAM_SFMT_PCM32 = 3,
     LIBVGMSTREAM_SFMT_FLOAT = 4,
+    LIBVGMSTREAM_SFMT_PCM16P = 5,
+    LIBVGMSTREAM_SFMT_PCM24P = 6,
+    LIBVGMSTREAM_SFMT_PCM32P = 7,
+    LIBVGMSTREAM_SFMT_FLOATP = 8,
 } libvgmstream_sfmt_t;
 
 /* current song info, may be copied around (values are info-only) */
@@ -101,6 +108,7 @@ typedef struct {
     //int frame_size;                       // when file has some configurable frame size
 
     /* sample info (may not be used depending on config) */
+    // ** when resampling all sample values are converted to output sample rate
     int64_t stream_samples;                 // file's max samples (not final play duration)
     int64_t loop_start;                     // loop start sample
     int64_t loop_end;                       // loop end sample
@@ -129,6 +137,8 @@ typedef struct {
     int format_id;                          // current format's ID (can be set when reopening streams to load a particular format)
                                             // ** this value WILL change without warning between vgmstream versions/commits
 
+    int input_sample_rate;                  // original file's sample rate before resampling (if any)
+
 } libvgmstream_format_t;
 
 /* current decoder state */
@@ -136,6 +146,7 @@ typedef struct {
     void* buf;                              // current decoded buf (valid after _decode until next call; may change between calls)
     int buf_samples;                        // current buffer samples (0 is possible in some cases)
     int buf_bytes;                          // current buffer bytes (channels * sample_size * samples)
+                                            // ** in planar formats each channel is buf_samples long (in _fill it's buf_samples passed)
 
     bool done;                              // when stream is done, based on config
                                             // ** note that with play_forever this flag is never set
@@ -185,6 +196,18 @@ typedef struct {
                                             // ** this type of downmixing is very simplistic and not recommended
 
     libvgmstream_sfmt_t force_sfmt;         // forces output buffer to be remixed into some sample format
+                                            // ** planar formats avoid interleaving for codecs that decode planar data
+
+    int render_samples;                     // max samples decoded per _render call (internal buffer size), 0 = default
+                                            // ** bigger values mean less calls but more memory; _fill renders up to this
+                                            //    directly into the caller's buf when it's big enough
+
+    int resample_rate;                      // resamples output to this sample rate, 0 = disabled (keeps stream's rate)
+    int resample_quality;                   // 0 = default (medium), 1 = low, 2 = medium, 3 = high (slower)
+
+    int io_buffer_size;                     // read buffer size in bytes for decoders that do their own IO (currently FFmpeg), 0 = default
+                                            // ** only applies to the next _open_stream; clamped to 0x1000..0x100000
+                                            // ** bigger values mean less read callbacks for high bitrate/multichannel streams
 
   //int format_id;                          // force a format (for example when loading new subsong of the same archive, for a minuscule speed up)
   //                                        // ** only applies when called before _open_stream
@@ -225,7 +248,8 @@ LIBVGMSTREAM_API int libvgmstream_render(libvgmstream_t* lib);
  * - returns < 0 on error
  * - buf must be at least as big as channels * sample_size * buf_samples
  * - note that may return less than requested samples (such as near EOF)
- * - needs copying around from internal bufs so may be slightly slower; mainly for cases when you have buf constraints
+ * - decodes directly into buf when it's big enough, otherwise copies from internal bufs (mainly the last part of buf)
+ * - in planar formats each channel starts at buf + sample_size * buf_samples * channel (even if less samples are returned)
  */
 LIBVGMSTREAM_API int libvgmstream_fill(libvgmstream_t* lib, void* buf, int buf_samples);
 
@@ -355,4 +379,73 @@ LIBVGMSTREAM_API bool libvgmstream_tags_next_tag(libvgmstream_tags_t* tags);
 LIBVGMSTREAM_API void libvgmstream_tags_free(libvgmstream_tags_t* tags);
 
 
+/*****************************************************************************/
+/* VOICE MIXER */
+
+/* Plays multiple streams at once (BGM layers, ambiences, one-shots, etc) mixed into a single float bus.
+ * Each voice is a regular libvgmstream_t configured to output float at the bus' sample rate. */
+
+/* mixer context/handle */
+typedef struct {
+    void* priv;                             // internal data
+
+    int channels;                           // bus channels
+    int sample_rate;                        // bus sample rate
+} libvgmstream_mix_t;
+
+typedef struct {
+    int channels;                           // bus channels, 0 = default (2)
+    int sample_rate;                        // bus sample rate, 0 = default (48000)
+                                            // ** voices with other sample rates are resampled
+    int max_voices;                         // max voices playing at once, 0 = default (32)
+    int render_samples;                     // max samples rendered per voice at once, 0 = default
+    int resample_quality;                   // see libvgmstream_config_t
+} libvgmstream_mix_config_t;
+
+typedef struct {
+    float gain;                             // voice volume (1.0 = unchanged)
+    float pan;                              // -1.0 = left .. 0.0 = center .. 1.0 = right (stereo+ buses only)
+    int64_t start_offset;                   // bus samples to wait before voice starts, from current mixer position
+} libvgmstream_mix_voice_t;
+
+/* Inits the mixer
+ * - config may be NULL to use defaults
+ * - returns NULL on error
+ */
+LIBVGMSTREAM_API libvgmstream_mix_t* libvgmstream_mix_init(libvgmstream_mix_config_t* cfg);
+
+/* Frees the mixer and all its voices.
+ */
+LIBVGMSTREAM_API void libvgmstream_mix_free(libvgmstream_mix_t* mix);
+
+/* Opens a stream as a new voice (same as _create, and cfg may be NULL too).
+ * - returns voice index (>= 0), or < 0 on error or if all voices are in use
+ * - sample format and rate in cfg are replaced to match the bus (downmix is set to bus channels if not set)
+ * - voice_cfg may be NULL (centered, no gain/offset)
+ */
+LIBVGMSTREAM_API int libvgmstream_mix_add_voice(libvgmstream_mix_t* mix, libstreamfile_t* libsf, int subsong, libvgmstream_config_t* cfg, libvgmstream_mix_voice_t* voice_cfg);
+
+/* Stops and closes a voice, whose index may be reused by next _add_voice.
+ */
+LIBVGMSTREAM_API void libvgmstream_mix_remove_voice(libvgmstream_mix_t* mix, int voice);
+
+/* Changes gain/pan of a playing voice (start_offset is ignored), applied on next _render.
+ */
+LIBVGMSTREAM_API void libvgmstream_mix_set_voice(libvgmstream_mix_t* mix, int voice, libvgmstream_mix_voice_t* voice_cfg);
+
+/* Returns voice's lib (to get format info, seek, etc), or NULL if voice isn't used.
+ */
+LIBVGMSTREAM_API libvgmstream_t* libvgmstream_mix_get_voice(libvgmstream_mix_t* mix, int voice);
+
+/* Returns if voice is still playing (false once its stream is done; voice must still be removed).
+ */
+LIBVGMSTREAM_API bool libvgmstream_mix_is_playing(libvgmstream_mix_t* mix, int voice);
+
+/* Renders all voices into buf, as interleaved float (-1.0 .. 1.0, may go beyond when many voices are summed).
+ * - buf must be at least as big as bus channels * buf_samples
+ * - always returns buf_samples (silence if no voice is playing), or < 0 on error
+ */
+LIBVGMSTREAM_API int libvgmstream_mix_render(libvgmstream_mix_t* mix, float* buf, int buf_samples);
+
+
 #endif
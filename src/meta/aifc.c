@@ -425,7 +425,8 @@ VGMSTREAM* init_vgmstream_aifc(STREAMFILE* sf) {
                 int entries = read_u16be(coef_offset + 0x04, sf);
                 if (version != 1) goto fail;
 
-                vadpcm_read_coefs_be(vgmstream, sf, coef_offset + 0x06, order, entries, 0);
+                if (!vadpcm_read_coefs_be(vgmstream, sf, coef_offset + 0x06, order, entries, 0))
+                    goto fail;
             }
 
             //vgmstream->num_samples = vadpcm_bytes_to_samples(data_size, channels); /* unneeded */
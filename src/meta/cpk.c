@@ -44,6 +44,7 @@ VGMSTREAM* init_vgmstream_cpk_memory(STREAMFILE* sf, STREAMFILE* sf_acb) {
      * early audio bank, that like standard AFS2 .awb comes with .acb */
     {
         int rows, rows_l, rows_h, i;
+        int c_ID, c_FileSize, c_ExtractSize;
         const char* name;
         const char* name_l;
         const char* name_h;
@@ -143,13 +144,16 @@ VGMSTREAM* init_vgmstream_cpk_memory(STREAMFILE* sf, STREAMFILE* sf_acb) {
         }
 
         /* save DataL sizes */
+        c_ID = utf_get_column(utf_l, "ID");
+        c_FileSize = utf_get_column(utf_l, "FileSize");
+        c_ExtractSize = utf_get_column(utf_l, "ExtractSize");
         for (i = 0; i < rows_l; i++) {
             uint16_t ID = 0;
             uint16_t FileSize, ExtractSize;
 
-            if (!utf_query_u16(utf_l, i, "ID", &ID) ||
-                !utf_query_u16(utf_l, i, "FileSize", &FileSize) ||
-                !utf_query_u16(utf_l, i, "ExtractSize", &ExtractSize))
+            if (!utf_query_col_u16(utf_l, i, c_ID, &ID) ||
+                !utf_query_col_u16(utf_l, i, c_FileSize, &FileSize) ||
+                !utf_query_col_u16(utf_l, i, c_ExtractSize, &ExtractSize))
                 goto fail;
 
             ID -= id_align;
@@ -160,13 +164,16 @@ VGMSTREAM* init_vgmstream_cpk_memory(STREAMFILE* sf, STREAMFILE* sf_acb) {
         }
 
         /* save DataH sizes */
+        c_ID = utf_get_column(utf_h, "ID");
+        c_FileSize = utf_get_column(utf_h, "FileSize");
+        c_ExtractSize = utf_get_column(utf_h, "ExtractSize");
         for (i = 0; i < rows_h; i++) {
             uint16_t ID = 0;
             uint32_t FileSize, ExtractSize;
 
-            if (!utf_query_u16(utf_h, i, "ID", &ID) ||
-                !utf_query_u32(utf_h, i, "FileSize", &FileSize) ||
-                !utf_query_u32(utf_h, i, "ExtractSize", &ExtractSize))
+            if (!utf_query_col_u16(utf_h, i, c_ID, &ID) ||
+                !utf_query_col_u32(utf_h, i, c_FileSize, &FileSize) ||
+                !utf_query_col_u32(utf_h, i, c_ExtractSize, &ExtractSize))
                 goto fail;
 
             ID -= id_align;
@@ -25,6 +25,7 @@ VGMSTREAM* init_vgmstream_csb(STREAMFILE* sf) {
      * Can stream from .cpk but this only loads memory data. */
     {
         int rows, sdl_rows, sdl_row, i;
+        int c_stmflg;
         const char *name;
         const char *row_name;
         const char *sdl_name;
@@ -78,10 +79,11 @@ VGMSTREAM* init_vgmstream_csb(STREAMFILE* sf) {
         if (target_subsong == 0) target_subsong = 1;
 
         /* get target subsong */
+        c_stmflg = utf_get_column(utf_sdl, "stmflg");
         for (i = 0; i < sdl_rows; i++) {
             uint8_t stream_flag;
 
-            if (!utf_query_u8(utf_sdl, i, "stmflg", &stream_flag))
+            if (!utf_query_col_u8(utf_sdl, i, c_stmflg, &stream_flag))
                 goto fail;
 
             /* only internal data for now (when 1 this refers to a .cpk subfile probably using "name", has size 0) */
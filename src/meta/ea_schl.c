@@ -375,7 +375,8 @@ static VGMSTREAM* init_vgmstream_ea_variable_header(STREAMFILE* sf, ea_header* e
             for (ch = 0; ch < ea->channels; ch++) {
                 int order = read_u32be(ea->coefs[ch] + 0x00, sf);
                 int entries = read_u32be(ea->coefs[ch] + 0x04, sf);
-                vadpcm_read_coefs_be(vgmstream, sf, ea->coefs[ch] + 0x08, order, entries, ch);
+                if (!vadpcm_read_coefs_be(vgmstream, sf, ea->coefs[ch] + 0x08, order, entries, ch))
+                    goto fail;
             }
             break;
 
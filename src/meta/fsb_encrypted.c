@@ -4,7 +4,7 @@
 #include "fsb_encrypted_streamfile.h"
 
 
-static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* key, size_t key_size, uint8_t flags);
+static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* header, const uint8_t* key, size_t key_size, uint8_t flags);
 
 /* fully encrypted FSBs */
 VGMSTREAM* init_vgmstream_fsb_encrypted(STREAMFILE* sf) {
@@ -21,13 +21,18 @@ VGMSTREAM* init_vgmstream_fsb_encrypted(STREAMFILE* sf) {
     if (!check_extensions(sf, "fsb,ps3,xen"))
         return NULL;
 
+    /* raw header, read once to quickly discard keys */
+    uint8_t header[FSB_HEADER_TEST_SIZE];
+    if (read_streamfile(header, 0x00, sizeof(header), sf) != sizeof(header))
+        return NULL;
+
     /* try fsbkey + all combinations of FSB4/5 and decryption algorithms */
     {
         uint8_t key[FSB_KEY_MAX];
         size_t key_size = read_key_file(key, FSB_KEY_MAX, sf);
 
         if (key_size) {
-            vgmstream = test_fsbkey(sf, key, key_size, MODE_FSBS);
+            vgmstream = test_fsbkey(sf, header, key, key_size, MODE_FSBS);
             return vgmstream;
         }
     }
@@ -38,7 +43,7 @@ VGMSTREAM* init_vgmstream_fsb_encrypted(STREAMFILE* sf) {
         for (int i = 0; i < fsbkey_list_count; i++) {
             fsbkey_info entry = fsbkey_list[i];
 
-            vgmstream = test_fsbkey(sf, (const uint8_t*)entry.key, entry.key_size, entry.flags);
+            vgmstream = test_fsbkey(sf, header, (const uint8_t*)entry.key, entry.key_size, entry.flags);
             if (vgmstream) break;
         }
     }
@@ -53,8 +58,24 @@ fail:
     return NULL;
 }
 
-static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* key, size_t key_size, uint8_t flags) {
-    STREAMFILE* temp_sf = NULL;
+static VGMSTREAM* open_fsb_decrypted(STREAMFILE* sf, const uint8_t* key, size_t key_size, int is_alt, int version) {
+    VGMSTREAM* vc = NULL;
+
+    STREAMFILE* temp_sf = setup_fsb_streamfile(sf, key, key_size, is_alt);
+    if (!temp_sf) return NULL;
+    //;dump_streamfile(temp_sf, is_alt);
+
+    if (version == 5)
+        vc = init_vgmstream_fsb5(temp_sf);
+    else
+        vc = init_vgmstream_fsb(temp_sf);
+
+    close_streamfile(temp_sf);
+    return vc;
+}
+
+/* only parses the full header when the decrypted ID matches a version allowed by the key */
+static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* header, const uint8_t* key, size_t key_size, uint8_t flags) {
     VGMSTREAM* vc = NULL;
 
     if (!key_size)
@@ -65,27 +86,14 @@ static VGMSTREAM* test_fsbkey(STREAMFILE* sf, const uint8_t* key, size_t key_siz
     bool test_alt  = flags & FLAG_ALT;
     bool test_std  = flags & FLAG_STD;
 
-    if (!vc && test_std && test_fsb_streamfile(sf, key, key_size, 0)) {
-        temp_sf = setup_fsb_streamfile(sf, key, key_size, 0);
-        if (!temp_sf) return NULL;
-        //;dump_streamfile(temp_sf, 0);
-
-        if (!vc && test_fsb4) vc = init_vgmstream_fsb(temp_sf);
-        if (!vc && test_fsb5) vc = init_vgmstream_fsb5(temp_sf);
+    for (int is_alt = 0; is_alt <= 1 && !vc; is_alt++) {
+        if ((is_alt && !test_alt) || (!is_alt && !test_std))
+            continue;
 
-       close_streamfile(temp_sf);
+        int version = test_fsb_header(header, FSB_HEADER_TEST_SIZE, key, key_size, is_alt);
+        if ((version == 5 && test_fsb5) || (version >= 1 && version <= 4 && test_fsb4))
+            vc = open_fsb_decrypted(sf, key, key_size, is_alt, version);
     }
 
-    if (!vc && test_alt && test_fsb_streamfile(sf, key, key_size, 1)) {
-        temp_sf = setup_fsb_streamfile(sf, key, key_size, 1);
-        if (!temp_sf) return NULL;
-        //;dump_streamfile(temp_sf, 1);
-
-        if (!vc  && test_fsb4) vc = init_vgmstream_fsb(temp_sf);
-        if (!vc && test_fsb5) vc = init_vgmstream_fsb5(temp_sf);
-
-        close_streamfile(temp_sf);
-    }
-    
     return vc;
 }
@@ -2,6 +2,7 @@
 #define _FSB_ENCRYPTED_STREAMFILE_H_
 
 #define FSB_KEY_MAX 0x80 /* known max ~0x33 */
+#define FSB_HEADER_TEST_SIZE 0x08
 
 
 typedef struct {
@@ -11,7 +12,7 @@ typedef struct {
 } fsb_decryption_data;
 
 /* Encrypted FSB info from guessfsb and fsbext */
-static size_t fsb_decryption_read(STREAMFILE* sf, uint8_t *dest, off_t offset, size_t length, fsb_decryption_data* data) {
+static void fsb_decrypt(uint8_t* buf, off_t offset, size_t size, const fsb_decryption_data* data) {
     static const unsigned char reverse_bits_table[] = { /* LUT to simplify, could use some bitswap function */
       //00   01   02   03   04   05   06   07   08   09   0A   0B   0C   0D   0E   0F
       0x00,0x80,0x40,0xC0,0x20,0xA0,0x60,0xE0,0x10,0x90,0x50,0xD0,0x30,0xB0,0x70,0xF0, //00
@@ -31,23 +32,23 @@ static size_t fsb_decryption_read(STREAMFILE* sf, uint8_t *dest, off_t offset, s
       0x07,0x87,0x47,0xC7,0x27,0xA7,0x67,0xE7,0x17,0x97,0x57,0xD7,0x37,0xB7,0x77,0xF7, //E0
       0x0F,0x8F,0x4F,0xCF,0x2F,0xAF,0x6F,0xEF,0x1F,0x9F,0x5F,0xDF,0x3F,0xBF,0x7F,0xFF  //F0
     };
-    size_t bytes_read;
-    int i;
-
-    bytes_read = read_streamfile(dest, offset, length, sf);
-
     /* decrypt data (inverted bits and xor) */
-    for (i = 0; i < bytes_read; i++) {
+    for (int i = 0; i < size; i++) {
         uint8_t xor = data->key[(offset + i) % data->key_size];
-        uint8_t val = dest[i];
+        uint8_t val = buf[i];
         if (data->is_alt) {
-            dest[i] = reverse_bits_table[val ^ xor];
+            buf[i] = reverse_bits_table[val ^ xor];
         }
         else {
-            dest[i] = reverse_bits_table[val] ^ xor;
+            buf[i] = reverse_bits_table[val] ^ xor;
         }
     }
+}
 
+static size_t fsb_decryption_read(STREAMFILE* sf, uint8_t* dest, off_t offset, size_t length, fsb_decryption_data* data) {
+    size_t bytes_read = read_streamfile(dest, offset, length, sf);
+
+    fsb_decrypt(dest, offset, bytes_read, data);
     return bytes_read;
 }
 
@@ -71,23 +72,35 @@ static STREAMFILE* setup_fsb_streamfile(STREAMFILE* sf, const uint8_t* key, size
     return new_sf;
 }
 
-/* same as above but doesn't open streamfile, so it's a tiny bit faster */
-static bool test_fsb_streamfile(STREAMFILE* sf, const uint8_t* key, size_t key_size, int is_alt) {
+/* Decrypts the start of the (raw) header with a key and returns the FSB version (1~5) if it looks correct, or 0.
+ * Done in memory without opening streamfiles, as most keys are wrong and this is tested for every key. */
+static int test_fsb_header(const uint8_t* header, size_t header_size, const uint8_t* key, size_t key_size, int is_alt) {
     fsb_decryption_data io_data = {0};
+    uint8_t buf[FSB_HEADER_TEST_SIZE];
 
-    if (!key_size || key_size >= FSB_KEY_MAX)
-        return false;
+    if (!key_size || key_size >= FSB_KEY_MAX || header_size < FSB_HEADER_TEST_SIZE)
+        return 0;
 
     memcpy(io_data.key, key, key_size);
     io_data.key_size = key_size;
     io_data.is_alt = is_alt;
 
-    /* setup subfile */
-    uint8_t tmp[0x04];
-    int bytes = fsb_decryption_read(sf, tmp, 0x00, 0x04, &io_data);
-    if (bytes != 0x04)
-        return false;
-    return (get_u32be(tmp) & 0xFFFFFF00) == get_id32be("FSB\0");
+    memcpy(buf, header, FSB_HEADER_TEST_SIZE);
+    fsb_decrypt(buf, 0x00, FSB_HEADER_TEST_SIZE, &io_data);
+
+    uint32_t id = get_u32be(buf + 0x00);
+    if ((id & 0xFFFFFF00) != get_id32be("FSB\0"))
+        return 0;
+
+    int version = (id & 0xFF) - '0';
+    if (version < 1 || version > 5)
+        return 0;
+
+    /* same as fsb5.c (should be enough to discard most false positives) */
+    if (version == 5 && get_u32le(buf + 0x04) > 0x01)
+        return 0;
+
+    return version;
 }
 
 #endif /* _FSB_ENCRYPTED_STREAMFILE_H_ */
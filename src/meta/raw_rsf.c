@@ -50,6 +50,9 @@ VGMSTREAM* init_vgmstream_raw_rsf(STREAMFILE* sf) {
     vgmstream->layout_type = layout_none;
     vgmstream->meta_type = meta_RSF;
 
+    vgmstream->codec_data = init_g721(channels);
+    if (!vgmstream->codec_data) goto fail;
+
     if (!vgmstream_open_stream(vgmstream, sf, 0))
         goto fail;
 
@@ -58,7 +61,6 @@ VGMSTREAM* init_vgmstream_raw_rsf(STREAMFILE* sf) {
         int i;
         for (i = 0; i < channels; i++) {
             vgmstream->ch[i].channel_start_offset= vgmstream->ch[i].offset = interleave * i;
-            g72x_init_state(&(vgmstream->ch[i].g72x_state));
         }
     }
 
@@ -904,6 +904,9 @@ VGMSTREAM* init_vgmstream_riff(STREAMFILE* sf) {
                 goto fail;
 
             for (int ch = 0; ch < fmt.channels; ch++) {
+                vgmstream->ch[ch].adpcm_coef_3by32 = calloc(0x20 * filter_order, sizeof(int32_t));
+                if (!vgmstream->ch[ch].adpcm_coef_3by32) goto fail;
+
                 for (int i = 0; i < filter_count * filter_order; i++) {
                     int coef = read_s32le(mwv_pflt_offset+0x10+i*0x04, sf);
                     vgmstream->ch[ch].adpcm_coef_3by32[i] = coef;
@@ -45,7 +45,21 @@ void txtp_clean(txtp_header_t* txtp) {
     for (int i = 0; i < txtp->vgmstream_count; i++) {
         close_vgmstream(txtp->vgmstream[i]);
     }
+    if (txtp->sources) {
+        for (int i = 0; i < txtp->entry_count; i++) {
+            free(txtp->sources[i]);
+        }
+    }
+    for (int i = 0; i < txtp->entry_count; i++) {
+        txtp_free_entry(&txtp->entry[i]);
+    }
+    for (int i = 0; i < txtp->group_count; i++) {
+        txtp_free_entry(&txtp->group[i].entry);
+    }
+    txtp_free_entry(&txtp->default_entry);
 
+    free(txtp->sources);
+    free(txtp->probes);
     free(txtp->vgmstream);
     free(txtp->group);
     free(txtp->entry);
@@ -100,17 +114,40 @@ void txtp_copy_config(play_config_t* dst, play_config_t* src) {
 }
 
 void txtp_add_mixing(txtp_entry_t* entry, txtp_mix_data_t* mix, txtp_mix_t command) {
-    if (entry->mixing_count + 1 > TXTP_MIXING_MAX) {
-        VGM_LOG("TXTP: too many mixes\n");
-        return;
-    }
-
     /* parser reads ch1 = first, but for mixing code ch0 = first
      * (if parser reads ch0 here it'll become -1 with meaning of "all channels" in mixing code) */
     mix->ch_dst--;
     mix->ch_src--;
     mix->command = command;
 
+    txtp_push_mixing(entry, mix);
+}
+
+/* adds a mix as-is to the entry's list */
+bool txtp_push_mixing(txtp_entry_t* entry, const txtp_mix_data_t* mix) {
+    if (entry->mixing_count + 1 > TXTP_MIXING_MAX) {
+        VGM_LOG("TXTP: too many mixes\n");
+        return false;
+    }
+
+    /* resize in steps if not enough (most entries have none or a few) */
+    if (entry->mixing_count + 1 > entry->mixing_max) {
+        txtp_mix_data_t* temp_mixing;
+
+        temp_mixing = realloc(entry->mixing, sizeof(txtp_mix_data_t) * (entry->mixing_max + 5));
+        if (!temp_mixing) return false;
+        entry->mixing = temp_mixing;
+        entry->mixing_max += 5;
+    }
+
     entry->mixing[entry->mixing_count] = *mix; /* memcpy'ed */
     entry->mixing_count++;
+    return true;
+}
+
+void txtp_free_entry(txtp_entry_t* entry) {
+    free(entry->mixing);
+    entry->mixing = NULL;
+    entry->mixing_count = 0;
+    entry->mixing_max = 0;
 }
@@ -21,6 +21,9 @@
 #define TXTP_GROUP_REPEAT 'R'
 #define TXTP_POSITION_LOOPS 'L'
 
+/* segmented groups with this many entries keep only a few open at once */
+#define TXTP_LAZY_SEGMENTS_MIN 16
+
 #define TXTP_BODY_INTRO 1
 #define TXTP_BODY_MAIN 2
 #define TXTP_BODY_OUTRO 3
@@ -88,8 +91,9 @@ typedef struct {
 
     uint32_t channel_mask;
 
+    txtp_mix_data_t* mixing; /* owned, only allocated as needed */
     int mixing_count;
-    txtp_mix_data_t mixing[TXTP_MIXING_MAX];
+    int mixing_max;
 
     play_config_t config;
 
@@ -125,6 +129,16 @@ typedef struct {
 
 } txtp_group_t;
 
+/* info of an entry closed after opening it (long segmented groups reopen entries when played) */
+typedef struct {
+    segment_info_t segment;
+    int32_t num_samples;
+    int32_t loop_start_sample;
+    int32_t loop_end_sample;
+    int bitrate;
+    uint32_t bitrate_hash; /* file+subsong to count repeated files once (0 if always counted) */
+} txtp_probe_t;
+
 typedef struct {
     txtp_entry_t* entry;
     size_t entry_count;
@@ -137,6 +151,9 @@ typedef struct {
 
     VGMSTREAM** vgmstream;
     size_t vgmstream_count;
+    uint8_t** sources; /* saved entry settings per vgmstream, to reopen (NULL if not a plain entry) */
+    txtp_probe_t* probes; /* per vgmstream, valid when closed */
+    STREAMFILE* sf; /* base .txtp (not owned) */
 
     uint32_t loop_start_segment;
     uint32_t loop_end_segment;
@@ -156,5 +173,7 @@ bool txtp_process(txtp_header_t* txtp, STREAMFILE* sf);
 
 void txtp_clean(txtp_header_t* txtp);
 void txtp_add_mixing(txtp_entry_t* entry, txtp_mix_data_t* mix, txtp_mix_t command);
+bool txtp_push_mixing(txtp_entry_t* entry, const txtp_mix_data_t* mix);
+void txtp_free_entry(txtp_entry_t* entry);
 void txtp_copy_config(play_config_t* dst, play_config_t* src);
 #endif
@@ -377,8 +377,7 @@ static void add_settings(txtp_entry_t* current, txtp_entry_t* entry, const char*
     if (entry->mixing_count > 0) {
         int i;
         for (i = 0; i < entry->mixing_count; i++) {
-            current->mixing[current->mixing_count] = entry->mixing[i];
-            current->mixing_count++;
+            txtp_push_mixing(current, &entry->mixing[i]);
         }
     }
 
@@ -836,6 +835,7 @@ static int add_group(txtp_header_t* txtp, char* line) {
 
     return 1;
 fail:
+    txtp_free_entry(&cfg.entry);
     return 0;
 }
 
@@ -921,6 +921,7 @@ static int add_entry(txtp_header_t* txtp, char* filename, int is_default) {
     if (is_default) {
         txtp->default_entry_set = 1;
         add_settings(&txtp->default_entry, &entry, NULL);
+        txtp_free_entry(&entry);
         return 1;
     }
 
@@ -949,8 +950,10 @@ static int add_entry(txtp_header_t* txtp, char* filename, int is_default) {
         txtp->group_pos++;
     }
 
+    txtp_free_entry(&entry);
     return 1;
 fail:
+    txtp_free_entry(&entry);
     return 0;
 }
 
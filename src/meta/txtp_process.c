@@ -1,4 +1,5 @@
 #include <math.h>
+#include <ctype.h>
 
 #include "txtp.h"
 #include "../coding/coding.h"
@@ -222,9 +223,43 @@ static bool is_absolute(const char* fn) {
     return fn[0] == '/' || fn[0] == '\\'  || fn[1] == ':';
 }
 
+/* open entry's file and apply settings (entry may be modified) */
+static VGMSTREAM* open_entry(STREAMFILE* sf, txtp_entry_t* entry) {
+    STREAMFILE* temp_sf = NULL;
+    const char* filename = entry->filename;
+
+    /* absolute paths are detected for convenience, but since it's hard to unify all OSs
+     * and plugins, they aren't "officially" supported nor documented, thus may or may not work */
+    if (is_absolute(filename))
+        temp_sf = open_streamfile(sf, filename); /* from path as is */
+    else
+        temp_sf = open_streamfile_by_filename(sf, filename); /* from current path */
+    if (!temp_sf) {
+        vgm_logi("TXTP: cannot open %s\n", filename);
+        return NULL;
+    }
+    temp_sf->stream_index = entry->subsong;
+    temp_sf->io_buffer_size = sf->io_buffer_size;
+
+    VGMSTREAM* vgmstream = init_vgmstream_from_STREAMFILE(temp_sf);
+    close_streamfile(temp_sf);
+    if (!vgmstream) {
+        vgm_logi("TXTP: cannot parse %s#%i\n", filename, entry->subsong);
+        return NULL;
+    }
+
+    apply_settings(vgmstream, entry);
+    return vgmstream;
+}
+
+static uint8_t* save_entry(txtp_entry_t* entry);
+static bool is_probe_only(txtp_header_t* txtp);
+static void probe_entry(txtp_header_t* txtp, int position);
+
 /* open all entries and apply settings to resulting VGMSTREAMs */
 static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
     bool has_silents = false;
+    bool probe_only = false;
 
 
     if (txtp->entry_count == 0)
@@ -235,10 +270,16 @@ static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
 
     txtp->vgmstream_count = txtp->entry_count;
 
+    /* may need to reopen entries later (not critical if fails) */
+    if (txtp->entry_count >= TXTP_LAZY_SEGMENTS_MIN) {
+        txtp->sources = calloc(txtp->entry_count, sizeof(uint8_t*));
+        txtp->probes = calloc(txtp->entry_count, sizeof(txtp_probe_t));
+        probe_only = is_probe_only(txtp);
+    }
+
 
     /* open all entry files first as they'll be modified by modes */
     for (int i = 0; i < txtp->vgmstream_count; i++) {
-        STREAMFILE* temp_sf = NULL;
         const char* filename = txtp->entry[i].filename;
 
         /* silent entry ignore */
@@ -248,26 +289,17 @@ static bool parse_entries(txtp_header_t* txtp, STREAMFILE* sf) {
             continue;
         }
 
-        /* absolute paths are detected for convenience, but since it's hard to unify all OSs
-         * and plugins, they aren't "officially" supported nor documented, thus may or may not work */
-        if (is_absolute(filename))
-            temp_sf = open_streamfile(sf, filename); /* from path as is */
-        else
-            temp_sf = open_streamfile_by_filename(sf, filename); /* from current path */
-        if (!temp_sf) {
-            vgm_logi("TXTP: cannot open %s\n", filename);
-            goto fail;
+        if (txtp->sources) {
+            txtp->sources[i] = save_entry(&txtp->entry[i]);
         }
-        temp_sf->stream_index = txtp->entry[i].subsong;
 
-        txtp->vgmstream[i] = init_vgmstream_from_STREAMFILE(temp_sf);
-        close_streamfile(temp_sf);
-        if (!txtp->vgmstream[i]) {
-            vgm_logi("TXTP: cannot parse %s#%i\n", filename, txtp->entry[i].subsong);
-            goto fail;
-        }
+        txtp->vgmstream[i] = open_entry(sf, &txtp->entry[i]);
+        if (!txtp->vgmstream[i]) goto fail;
 
-        apply_settings(txtp->vgmstream[i], &txtp->entry[i]);
+        /* only keep info until played, so long lists don't keep all entries in memory at once */
+        if (probe_only) {
+            probe_entry(txtp, i);
+        }
     }
 
     if (has_silents) {
@@ -281,6 +313,243 @@ fail:
 }
 
 
+/*******************************************************************************/
+/* LAZY SEGMENTS                                                               */
+/*******************************************************************************/
+
+/* Long segmented groups only keep a few entries open (see segmented layout), and the rest are reopened
+ * re-applying original settings (saved before opening since applying modifies the entry). Saved entries
+ * include their mixing list after the entry. Closed entries keep some info (probe) to setup the layout. */
+
+typedef struct {
+    STREAMFILE* sf;
+    uint8_t** sources;
+    int count;
+} txtp_lazy_t;
+
+static uint8_t* save_entry(txtp_entry_t* entry) {
+    size_t mixing_size = entry->mixing_count * sizeof(txtp_mix_data_t);
+
+    uint8_t* buf = malloc(sizeof(txtp_entry_t) + mixing_size);
+    if (!buf) return NULL;
+
+    memcpy(buf, entry, sizeof(txtp_entry_t));
+    if (mixing_size)
+        memcpy(buf + sizeof(txtp_entry_t), entry->mixing, mixing_size);
+    return buf;
+}
+
+/* entry must be freed after use */
+static bool load_entry(txtp_entry_t* entry, const uint8_t* buf) {
+    const txtp_mix_data_t* mixing = (const txtp_mix_data_t*)(buf + sizeof(txtp_entry_t));
+
+    memcpy(entry, buf, sizeof(txtp_entry_t));
+    entry->mixing = NULL;
+    entry->mixing_count = 0;
+    entry->mixing_max = 0;
+
+    for (int i = 0; i < ((const txtp_entry_t*)buf)->mixing_count; i++) {
+        if (!txtp_push_mixing(entry, &mixing[i]))
+            return false;
+    }
+    return true;
+}
+
+/* opens a saved entry (settings are applied to a copy, so it can be reopened) */
+static VGMSTREAM* open_saved_entry(STREAMFILE* sf, const uint8_t* buf) {
+    txtp_entry_t entry;
+    VGMSTREAM* vgmstream = NULL;
+
+    if (load_entry(&entry, buf))
+        vgmstream = open_entry(sf, &entry);
+    txtp_free_entry(&entry);
+    return vgmstream;
+}
+
+/* a long list of plain entries without groups ends up as a single lazy segmented group, so entries
+ * may be closed as soon as they are opened (otherwise groups need them open) */
+static bool is_probe_only(txtp_header_t* txtp) {
+    if (!txtp->sources || !txtp->probes)
+        return false;
+    if (txtp->group_count > 0 || !txtp->is_segmented)
+        return false;
+
+    for (int i = 0; i < txtp->entry_count; i++) {
+        if (is_silent(txtp->entry[i].filename))
+            return false;
+    }
+    return true;
+}
+
+static bool is_sublayout(VGMSTREAM* vgmstream) {
+    return vgmstream->layout_type == layout_segmented || vgmstream->layout_type == layout_layered;
+}
+
+/* same as the bitrate calcs, repeated files (+ subsong) are only counted once */
+static uint32_t get_bitrate_hash(txtp_entry_t* entry) {
+    uint32_t hash = 2166136261;
+
+    for (int i = 0; entry->filename[i] != '\0'; i++) {
+        char c = tolower(entry->filename[i]);
+        hash = (hash * 16777619) ^ (uint8_t)c;
+    }
+    hash = (hash * 16777619) ^ (uint32_t)entry->subsong;
+
+    return hash ? hash : 1;
+}
+
+/* save entry's info and close it (sublayouts are kept open since they can't be lazy segments) */
+static void probe_entry(txtp_header_t* txtp, int position) {
+    VGMSTREAM* vgmstream = txtp->vgmstream[position];
+    txtp_probe_t* probe = &txtp->probes[position];
+
+    if (!vgmstream || is_sublayout(vgmstream))
+        return;
+
+    /* before setting up as a segment, that may remove loops */
+    probe->num_samples = vgmstream->num_samples;
+    probe->loop_start_sample = vgmstream->loop_start_sample;
+    probe->loop_end_sample = vgmstream->loop_end_sample;
+
+    probe->bitrate = get_vgmstream_average_bitrate(vgmstream);
+    probe->bitrate_hash = vgmstream->stream_size ? 0 : get_bitrate_hash(&txtp->entry[position]);
+
+    get_segment_info(vgmstream, position, &probe->segment);
+
+    close_vgmstream(vgmstream);
+    txtp->vgmstream[position] = NULL;
+}
+
+/* reopen probed entries, when they end up in a group that needs them */
+static bool reopen_entries(txtp_header_t* txtp, int position, int count) {
+
+    for (int i = position; i < position + count; i++) {
+        if (txtp->vgmstream[i])
+            continue;
+        if (!txtp->sources || !txtp->sources[i])
+            return false;
+
+        txtp->vgmstream[i] = open_saved_entry(txtp->sf, txtp->sources[i]);
+        if (!txtp->vgmstream[i])
+            return false;
+    }
+
+    return true;
+}
+
+static void get_entry_loops(txtp_header_t* txtp, int position, int32_t* p_num_samples, int32_t* p_loop_start, int32_t* p_loop_end) {
+    VGMSTREAM* vgmstream = txtp->vgmstream[position];
+
+    if (vgmstream) {
+        *p_num_samples = vgmstream->num_samples;
+        *p_loop_start = vgmstream->loop_start_sample;
+        *p_loop_end = vgmstream->loop_end_sample;
+    }
+    else {
+        *p_num_samples = txtp->probes[position].num_samples;
+        *p_loop_start = txtp->probes[position].loop_start_sample;
+        *p_loop_end = txtp->probes[position].loop_end_sample;
+    }
+}
+
+static bool is_lazy_group(txtp_header_t* txtp, int position, int count) {
+    if (count < TXTP_LAZY_SEGMENTS_MIN || !txtp->sources || !txtp->probes)
+        return false;
+
+    /* only plain entries can be reopened */
+    for (int i = position; i < position + count; i++) {
+        if (!txtp->sources[i])
+            return false;
+        if (txtp->vgmstream[i] && is_sublayout(txtp->vgmstream[i]))
+            return false;
+    }
+
+    return true;
+}
+
+/* average of unique files, like the bitrate calcs of open segments */
+static int get_lazy_bitrate(txtp_header_t* txtp, int position, int count) {
+    int bitrate = 0, uniques = 0;
+
+    for (int i = position; i < position + count; i++) {
+        txtp_probe_t* probe = &txtp->probes[i];
+        bool is_repeat = false;
+
+        if (!probe->bitrate)
+            continue;
+
+        for (int j = position; j < i && probe->bitrate_hash; j++) {
+            if (txtp->probes[j].bitrate && txtp->probes[j].bitrate_hash == probe->bitrate_hash) {
+                is_repeat = true;
+                break;
+            }
+        }
+        if (is_repeat)
+            continue;
+
+        bitrate += probe->bitrate;
+        uniques++;
+    }
+
+    return uniques ? bitrate / uniques : 0;
+}
+
+static void free_lazy(void* priv) {
+    txtp_lazy_t* lazy = priv;
+    if (!lazy)
+        return;
+
+    if (lazy->sources) {
+        for (int i = 0; i < lazy->count; i++) {
+            free(lazy->sources[i]);
+        }
+    }
+    free(lazy->sources);
+    close_streamfile(lazy->sf);
+    free(lazy);
+}
+
+static VGMSTREAM* open_lazy_segment(void* priv, int segment) {
+    txtp_lazy_t* lazy = priv;
+    if (segment < 0 || segment >= lazy->count)
+        return NULL;
+
+    return open_saved_entry(lazy->sf, lazy->sources[segment]);
+}
+
+/* setups the layout from probed entries, which are reopened by the layout when needed */
+static bool setup_lazy_segments(txtp_header_t* txtp, segmented_layout_data* data, int position, int count, int loop_segment) {
+    txtp_lazy_t* lazy = NULL;
+    segment_info_t* info = NULL;
+    bool ok;
+
+    lazy = calloc(1, sizeof(txtp_lazy_t));
+    if (!lazy) goto fail;
+
+    lazy->sf = reopen_streamfile(txtp->sf, 0);
+    lazy->sources = calloc(count, sizeof(uint8_t*));
+    lazy->count = count;
+    if (!lazy->sf || !lazy->sources)
+        goto fail;
+
+    info = malloc(count * sizeof(segment_info_t));
+    if (!info) goto fail;
+
+    for (int i = 0; i < count; i++) {
+        info[i] = txtp->probes[i + position].segment;
+        lazy->sources[i] = txtp->sources[i + position];
+        txtp->sources[i + position] = NULL;
+    }
+
+    ok = setup_layout_segmented_lazy(data, info, loop_segment, open_lazy_segment, free_lazy, lazy);
+    free(info);
+    return ok;
+fail:
+    free_lazy(lazy);
+    return false;
+}
+
+
 /*******************************************************************************/
 /* GROUPS                                                                      */
 /*******************************************************************************/
@@ -288,12 +557,39 @@ fail:
 static void update_vgmstream_list(VGMSTREAM* vgmstream, txtp_header_t* txtp, int position, int count) {
     //;VGM_LOG("TXTP: compact position=%i count=%i, vgmstreams=%i\n", position, count, txtp->vgmstream_count);
 
+    /* grouped entries can't be reopened */
+    if (txtp->sources) {
+        for (int i = position; i < position + count; i++) {
+            free(txtp->sources[i]);
+            txtp->sources[i] = NULL;
+        }
+    }
+
+    /* grouped entries (except the first) are overwritten below */
+    for (int i = position + 1; i < position + count; i++) {
+        txtp_free_entry(&txtp->entry[i]);
+    }
+
     /* sets and compacts vgmstream list pulling back all following entries */
     txtp->vgmstream[position] = vgmstream;
     for (int i = position + count; i < txtp->vgmstream_count; i++) {
         //;VGM_LOG("TXTP: copy %i to %i\n", i, i + 1 - count);
         txtp->vgmstream[i + 1 - count] = txtp->vgmstream[i];
         txtp->entry[i + 1 - count] = txtp->entry[i]; /* memcpy old settings for other groups */
+        if (txtp->sources && count != 1) {
+            txtp->sources[i + 1 - count] = txtp->sources[i];
+            txtp->sources[i] = NULL;
+        }
+        if (txtp->probes) {
+            txtp->probes[i + 1 - count] = txtp->probes[i];
+        }
+    }
+
+    /* trailing entries were moved (mixing is owned by the moved copy) */
+    for (int i = txtp->vgmstream_count + 1 - count; i < txtp->vgmstream_count; i++) {
+        txtp->entry[i].mixing = NULL;
+        txtp->entry[i].mixing_count = 0;
+        txtp->entry[i].mixing_max = 0;
     }
 
     /* list can only become smaller, no need to alloc/free/etc */
@@ -370,19 +666,34 @@ static bool make_group_segment(txtp_header_t* txtp, txtp_group_t* grp, int posit
     }
 
 
+    /* long groups close most segments until needed (entries may already be closed) */
+    bool is_lazy = is_lazy_group(txtp, position, count);
+    if (is_lazy) {
+        for (int i = 0; i < count; i++) {
+            probe_entry(txtp, i + position);
+        }
+    }
+    else {
+        if (!reopen_entries(txtp, position, count))
+            goto fail;
+    }
+
     /* fix loop keep (do it before init'ing as loops/metadata may be disabled for segments) */
     int32_t loop_start_sample = 0, loop_end_sample = 0;
     if (loop_flag && txtp->is_loop_keep) {
         int32_t current_samples = 0;
         for (int i = 0; i < count; i++) {
-            if (loop_start == i+1 /*&& txtp->vgmstream[i + position]->loop_start_sample*/) {
-                loop_start_sample = current_samples + txtp->vgmstream[i + position]->loop_start_sample;
+            int32_t entry_samples, entry_loop_start, entry_loop_end;
+            get_entry_loops(txtp, i + position, &entry_samples, &entry_loop_start, &entry_loop_end);
+
+            if (loop_start == i+1 /*&& entry_loop_start*/) {
+                loop_start_sample = current_samples + entry_loop_start;
             }
 
-            current_samples += txtp->vgmstream[i + position]->num_samples;
+            current_samples += entry_samples;
 
-            if (loop_end == i+1 && txtp->vgmstream[i + position]->loop_end_sample) {
-                loop_end_sample = current_samples - txtp->vgmstream[i + position]->num_samples + txtp->vgmstream[i + position]->loop_end_sample;
+            if (loop_end == i+1 && entry_loop_end) {
+                loop_end_sample = current_samples - entry_samples + entry_loop_end;
             }
         }
     }
@@ -391,15 +702,22 @@ static bool make_group_segment(txtp_header_t* txtp, txtp_group_t* grp, int posit
     data_s = init_layout_segmented(count);
     if (!data_s) goto fail;
 
-    /* copy each subfile */
-    for (int i = 0; i < count; i++) {
-        data_s->segments[i] = txtp->vgmstream[i + position];
-        txtp->vgmstream[i + position] = NULL; /* will be freed by layout */
+    if (is_lazy) {
+        /* setup from closed entries */
+        if (!setup_lazy_segments(txtp, data_s, position, count, loop_flag ? loop_start - 1 : -1))
+            goto fail;
     }
+    else {
+        /* copy each subfile */
+        for (int i = 0; i < count; i++) {
+            data_s->segments[i] = txtp->vgmstream[i + position];
+            txtp->vgmstream[i + position] = NULL; /* will be freed by layout */
+        }
 
-    /* setup VGMSTREAMs */
-    if (!setup_layout_segmented(data_s))
-        goto fail;
+        /* setup VGMSTREAMs */
+        if (!setup_layout_segmented(data_s))
+            goto fail;
+    }
 
     /* build the layout VGMSTREAM */
     vgmstream = allocate_segmented_vgmstream(data_s, loop_flag, loop_start - 1, loop_end - 1);
@@ -407,7 +725,7 @@ static bool make_group_segment(txtp_header_t* txtp, txtp_group_t* grp, int posit
 
     /* custom meta name if all parts don't match */
     for (int i = 0; i < count; i++) {
-        if (vgmstream->meta_type != data_s->segments[i]->meta_type) {
+        if (vgmstream->meta_type != data_s->segment_info[i].meta_type) {
             vgmstream->meta_type = meta_TXTP;
             break;
         }
@@ -419,6 +737,12 @@ static bool make_group_segment(txtp_header_t* txtp, txtp_group_t* grp, int posit
         vgmstream->loop_end_sample = loop_end_sample;
     }
 
+    /* bitrate can't be calculated from closed segments */
+    if (is_lazy && vgmstream->coding_type != coding_SILENCE && vgmstream->sample_rate > 0) {
+        int bitrate = get_lazy_bitrate(txtp, position, count);
+        vgmstream->stream_size = (int64_t)bitrate * vgmstream->num_samples / vgmstream->sample_rate / 8;
+    }
+
 
     /* set new vgmstream and reorder positions */
     update_vgmstream_list(vgmstream, txtp, position, count);
@@ -622,7 +946,11 @@ static bool parse_groups(txtp_header_t* txtp) {
 
         /* group may also have settings (like downmixing) */
         apply_settings(txtp->vgmstream[grp->position], &grp->entry);
+        txtp_free_entry(&txtp->entry[grp->position]);
         txtp->entry[grp->position] = grp->entry; /* memcpy old settings for subgroups */
+        grp->entry.mixing = NULL; /* moved */
+        grp->entry.mixing_count = 0;
+        grp->entry.mixing_max = 0;
     }
 
     /* final tweaks (should be integrated with the above?) */
@@ -659,6 +987,8 @@ fail:
 bool txtp_process(txtp_header_t* txtp, STREAMFILE* sf) {
     bool ok;
 
+    txtp->sf = sf;
+
     /* process files in the .txtp */
     ok = parse_entries(txtp, sf);
     if (!ok) goto fail;
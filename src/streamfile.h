@@ -73,6 +73,9 @@ typedef struct _STREAMFILE {
      * Not ideal here, but it was the simplest way to pass to all init_vgmstream_x functions. */
     int stream_index; /* 0=default/auto (first), 1=first, N=Nth */
 
+    /* Read buffer size for decoders that do their own IO (FFmpeg), passed the same way. 0=default */
+    int io_buffer_size;
+
 } STREAMFILE;
 
 /* All open_ fuctions should be safe to call with wrong/null parameters.
@@ -102,4 +102,62 @@ fail:
     return 0;
 }
 
+/* Copy bits from ib to ob (same as N bl_get + bl_put). When input is byte-aligned (usual case) moves
+ * 32b per step, shifting and merging into the output's current byte, since output may not be aligned. */
+static inline int bl_copy(bitstream_t* ob, bitstream_t* ib, uint32_t bits) {
+    uint32_t value;
+
+    if (ib->b_off + bits > ib->bufsize * 8 || ob->b_off + bits > ob->bufsize * 8)
+        return 0;
+
+    if (ib->b_off % 8 == 0 && bits >= 8) {
+        const uint8_t* src = &ib->buf[ib->b_off / 8];
+        uint8_t* dst = &ob->buf[ob->b_off / 8];
+        uint32_t shift = ob->b_off % 8;
+        uint32_t bytes = bits / 8;
+        uint64_t acc = dst[0] & ((1u << shift) - 1); /* lower bits already in output */
+
+        ib->b_off += bytes * 8;
+        ob->b_off += bytes * 8;
+        bits -= bytes * 8;
+
+        while (bytes >= 4) {
+            value = (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+            acc |= (uint64_t)value << shift;
+            dst[0] = (uint8_t)(acc >>  0);
+            dst[1] = (uint8_t)(acc >>  8);
+            dst[2] = (uint8_t)(acc >> 16);
+            dst[3] = (uint8_t)(acc >> 24);
+            acc >>= 32;
+
+            src += 4;
+            dst += 4;
+            bytes -= 4;
+        }
+
+        while (bytes > 0) {
+            acc |= (uint64_t)src[0] << shift;
+            dst[0] = (uint8_t)acc;
+            acc >>= 8;
+
+            src += 1;
+            dst += 1;
+            bytes -= 1;
+        }
+
+        /* partial byte with remaining upper bits (rest set to 0 like bl_put) */
+        if (shift)
+            dst[0] = (uint8_t)acc;
+    }
+
+    while (bits > 0) {
+        uint32_t step = bits > 32 ? 32 : bits;
+        bl_get(ib, step, &value);
+        bl_put(ob, step, value);
+        bits -= step;
+    }
+
+    return 1;
+}
+
 #endif
@@ -2,6 +2,7 @@
 #define _BITSTREAM_MSB_H
 
 #include <stdint.h>
+#include <string.h>
 
 /* Simple bitreader for MPEG/standard bit style, in 'most significant byte' (MSB) format.
  * Example: with 0x1234 = 00010010 00110100, reading 5b + 6b = 00010 010001
@@ -146,6 +147,110 @@ static inline uint32_t bm_read(bitstream_t* ib, uint32_t bits) {
     return value;
 }
 
+
+/* Cached reader for hot loops reading many small values: keeps upcoming bits in a 64-bit
+ * cache (MSB first) refilled by whole words, rather than assembling bytes on every read.
+ * Same results as bm_read/bm_skip (reading past max returns 0 and doesn't advance). */
+typedef struct {
+    const uint8_t* buf;
+    uint32_t bufsize;
+    uint32_t pos;           // next byte to load
+    uint64_t cache;         // upcoming bits in upper part (lower bits may have next partial byte)
+    uint32_t cache_bits;    // valid bits in cache
+    uint32_t b_max;         // max size in bits
+    uint32_t b_off;         // current offset in bits inside buffer
+} bm_cache_t;
+
+static inline void bmc_refill(bm_cache_t* bc) {
+    if (bc->pos + 8 <= bc->bufsize) {
+        const uint8_t* p = &bc->buf[bc->pos];
+        uint64_t word =
+                ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+                ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) | ((uint64_t)p[6] <<  8) | ((uint64_t)p[7] <<  0);
+        uint32_t bytes = (64 - bc->cache_bits) / 8;
+
+        /* bits below the loaded bytes are the same as the next refill will load, so OR is fine */
+        bc->cache |= word >> bc->cache_bits;
+        bc->pos += bytes;
+        bc->cache_bits += bytes * 8;
+        return;
+    }
+
+    while (bc->cache_bits <= 56 && bc->pos < bc->bufsize) {
+        bc->cache |= (uint64_t)bc->buf[bc->pos] << (56 - bc->cache_bits);
+        bc->pos++;
+        bc->cache_bits += 8;
+    }
+}
+
+static inline void bmc_setup(bm_cache_t* bc, const uint8_t* buf, uint32_t bufsize) {
+    bc->buf = buf;
+    bc->bufsize = bufsize;
+    bc->pos = 0;
+    bc->cache = 0;
+    bc->cache_bits = 0;
+    bc->b_max = bufsize * 8;
+    bc->b_off = 0;
+}
+
+static inline int bmc_skip(bm_cache_t* bc, uint32_t bits) {
+    uint32_t sub;
+
+    if (bc->b_off + bits > bc->b_max)
+        return 0;
+
+    bc->b_off += bits;
+    if (bits < bc->cache_bits) {
+        bc->cache <<= bits;
+        bc->cache_bits -= bits;
+        return 1;
+    }
+
+    /* reload at new position */
+    bc->pos = bc->b_off / 8;
+    bc->cache = 0;
+    bc->cache_bits = 0;
+
+    sub = bc->b_off % 8;
+    if (sub) {
+        bmc_refill(bc);
+        bc->cache <<= sub;
+        bc->cache_bits -= sub;
+    }
+    return 1;
+}
+
+static inline int bmc_pos(bm_cache_t* bc) {
+    return bc->b_off;
+}
+
+/* Get next bits (max 32) without consuming them (past max reads 0s). */
+static inline uint32_t bmc_peek(bm_cache_t* bc, uint32_t bits) {
+    if (bits == 0 || bits > 32)
+        return 0;
+    if (bc->cache_bits < bits)
+        bmc_refill(bc);
+    return (uint32_t)(bc->cache >> (64 - bits));
+}
+
+/* Consume peeked bits. */
+static inline void bmc_consume(bm_cache_t* bc, uint32_t bits) {
+    bc->cache <<= bits;
+    bc->cache_bits -= bits;
+    bc->b_off += bits;
+}
+
+static inline uint32_t bmc_read(bm_cache_t* bc, uint32_t bits) {
+    uint32_t value;
+
+    if (bits > 32 || bc->b_off + bits > bc->b_max)
+        return 0;
+
+    value = bmc_peek(bc, bits);
+    bmc_consume(bc, bits);
+    return value;
+}
+
 /* Write bits (max 32) to buf and update the bit offset. Order is BE (MSB). */
 static inline int bm_put(bitstream_t* ob, uint32_t bits, uint32_t value) {
     uint32_t shift, pos;
@@ -179,4 +284,69 @@ fail:
     return 0;
 }
 
+/* Copy bits from ib to ob (same as bm_get + bm_put of 1 bit at a time, but by whole bytes when possible).
+ * Bits past ib's max are written as 0s and writing stops at ob's max, returning 0 in both cases. */
+static inline int bm_copy(bitstream_t* ob, bitstream_t* ib, uint32_t bits) {
+    uint32_t bits_out, bits_in, value;
+    int ok;
+
+    bits_out = ob->b_off < ob->b_max ? ob->b_max - ob->b_off : 0;
+    if (bits_out > bits)
+        bits_out = bits;
+    bits_in = ib->b_off < ib->b_max ? ib->b_max - ib->b_off : 0;
+    if (bits_in > bits_out)
+        bits_in = bits_out;
+    ok = (bits_in == bits);
+
+    /* align output to a byte */
+    if (ob->b_off % 8 && bits_in) {
+        uint32_t head = 8 - ob->b_off % 8;
+        if (head > bits_in)
+            head = bits_in;
+        bm_get(ib, head, &value);
+        bm_put(ob, head, value);
+        bits_in -= head;
+        bits_out -= head;
+    }
+
+    /* whole output bytes */
+    if (bits_in >= 8) {
+        uint32_t bytes = bits_in / 8;
+        uint32_t shift = ib->b_off % 8;
+        const uint8_t* src = &ib->buf[ib->b_off / 8];
+        uint8_t* dst = &ob->buf[ob->b_off / 8];
+
+        if (shift == 0) {
+            memcpy(dst, src, bytes);
+        }
+        else {
+            /* src[i+1] is always inside ib since a non-aligned offset has 8+ bits left */
+            uint32_t i;
+            for (i = 0; i < bytes; i++) {
+                dst[i] = (uint8_t)((src[i] << shift) | (src[i+1] >> (8 - shift)));
+            }
+        }
+
+        ib->b_off += bytes * 8;
+        ob->b_off += bytes * 8;
+        bits_in -= bytes * 8;
+        bits_out -= bytes * 8;
+    }
+
+    if (bits_in) {
+        bm_get(ib, bits_in, &value);
+        bm_put(ob, bits_in, value);
+        bits_out -= bits_in;
+    }
+
+    /* past input max */
+    while (bits_out) {
+        uint32_t zeros = bits_out > 32 ? 32 : bits_out;
+        bm_put(ob, zeros, 0);
+        bits_out -= zeros;
+    }
+
+    return ok;
+}
+
 #endif
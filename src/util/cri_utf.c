@@ -50,6 +50,7 @@ struct utf_context {
         uint8_t flag;
         uint8_t type;
         const char* name;
+        uint32_t name_hash;     /* to skip most strcmp when finding columns */
         uint32_t offset;
     } *schema;
 
@@ -64,6 +65,16 @@ struct utf_context {
 };
 
 
+/* FNV-1a */
+static uint32_t get_name_hash(const char* name) {
+    uint32_t hash = 0x811c9dc5;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
 /* @UTF table context creation */
 utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const char** p_row_name) {
     utf_context* utf = NULL;
@@ -159,6 +170,7 @@ utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const
             utf->schema[i].flag = info & COLUMN_BITMASK_FLAG;
             utf->schema[i].type = info & COLUMN_BITMASK_TYPE;
             utf->schema[i].name = NULL;
+            utf->schema[i].name_hash = 0;
             utf->schema[i].offset = 0;
 
             /* known flags are name+default or name+row, but name+default+row is mentioned in VGMToolbox
@@ -201,6 +213,7 @@ utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const
 
             if (utf->schema[i].flag & COLUMN_FLAG_NAME) {
                 utf->schema[i].name = utf->string_table + name_offset;
+                utf->schema[i].name_hash = get_name_hash(utf->schema[i].name);
             }
 
             if (utf->schema[i].flag & COLUMN_FLAG_DEFAULT) {
@@ -247,12 +260,13 @@ void utf_close(utf_context* utf) {
 
 int utf_get_column(utf_context* utf, const char* column_name) {
     int i;
+    uint32_t name_hash = get_name_hash(column_name);
 
     /* find target column */
     for (i = 0; i < utf->columns; i++) {
         struct utf_column_t* col = &utf->schema[i];
 
-        if (col->name == NULL || strcmp(col->name, column_name) != 0)
+        if (col->name == NULL || col->name_hash != name_hash || strcmp(col->name, column_name) != 0)
             continue;
         return i;
     }
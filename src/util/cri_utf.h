@@ -22,6 +22,7 @@ typedef struct utf_context utf_context;
 utf_context* utf_open(STREAMFILE* sf, uint32_t table_offset, int* p_rows, const char** p_row_name);
 void utf_close(utf_context* utf);
 
+/* returns column index for utf_query_col_* calls (-1 if not found) */
 int utf_get_column(utf_context* utf, const char* column_name);
 
 /* query calls (passing column index is faster, when you have to read lots of rows) */
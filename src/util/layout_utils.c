@@ -233,21 +233,25 @@ fail:
 /* helper for easier creation of segments */
 VGMSTREAM* allocate_segmented_vgmstream(segmented_layout_data* data, int loop_flag, int loop_start_segment, int loop_end_segment) {
     VGMSTREAM* vgmstream = NULL;
+    const segment_info_t* info = data->segment_info; /* from setup (segments may be closed in lazy mode) */
     int channel_layout;
     int i, sample_rate;
     int32_t num_samples, loop_start, loop_end;
-    coding_t coding_type = data->segments[0]->coding_type;
+    coding_t coding_type;
+
+    if (!info) goto fail;
+    coding_type = info[0].coding_type;
 
     /* save data */
-    channel_layout = data->segments[0]->channel_layout;
+    channel_layout = info[0].channel_layout;
     num_samples = 0;
     loop_start = 0;
     loop_end = 0;
     sample_rate = 0;
     for (i = 0; i < data->segment_count; i++) {
-        /* needs get_samples since element may use play settings */
-        int32_t segment_samples = vgmstream_get_samples(data->segments[i]);
-        int segment_rate = data->segments[i]->sample_rate;
+        /* play samples since element may use play settings */
+        int32_t segment_samples = info[i].samples;
+        int segment_rate = info[i].sample_rate;
 
         if (loop_flag && i == loop_start_segment)
             loop_start = num_samples;
@@ -258,14 +262,14 @@ VGMSTREAM* allocate_segmented_vgmstream(segmented_layout_data* data, int loop_fl
             loop_end = num_samples;
 
         /* inherit first segment's layout but only if all segments' layout match */
-        if (channel_layout != 0 && channel_layout != data->segments[i]->channel_layout)
+        if (channel_layout != 0 && channel_layout != info[i].channel_layout)
             channel_layout = 0;
 
         if (sample_rate < segment_rate)
             sample_rate = segment_rate;
 
         if (coding_type == coding_SILENCE)
-            coding_type = data->segments[i]->coding_type;
+            coding_type = info[i].coding_type;
     }
 
     /* respect loop_flag even when no loop_end found as it's possible file loops are set outside */
@@ -275,7 +279,7 @@ VGMSTREAM* allocate_segmented_vgmstream(segmented_layout_data* data, int loop_fl
     vgmstream = allocate_vgmstream(data->output_channels, loop_flag);
     if (!vgmstream) goto fail;
 
-    vgmstream->meta_type = data->segments[0]->meta_type;
+    vgmstream->meta_type = info[0].meta_type;
     vgmstream->sample_rate = sample_rate;
     vgmstream->num_samples = num_samples;
     vgmstream->loop_start_sample = loop_start;
@@ -302,9 +306,12 @@ void blocked_count_samples(VGMSTREAM* vgmstream, STREAMFILE* sf, blocked_counter
     int block_samples;
     off_t max_offset = get_streamfile_size(sf);
 
+    /* blocks are walked anyway, so save them for seeking */
+    blocked_index_free(vgmstream);
+
     vgmstream->next_block_offset = cfg->offset;
     do {
-        block_update(vgmstream->next_block_offset, vgmstream);
+        block_update_indexed(vgmstream->next_block_offset, vgmstream);
 
         if (vgmstream->current_block_samples < 0 || vgmstream->current_block_size == 0xFFFFFFFF)
             break;
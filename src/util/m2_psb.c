@@ -131,6 +131,11 @@ struct psb_context_t {
     char* keys;
     int* keys_pos;
     int keys_count;
+    int keys_sorted; /* keys are in strcmp order, for faster lookups */
+
+    /* last object whose key list was checked (usually queried for several keys in a row) */
+    uint8_t* sorted_object;
+    int sorted_object_flag;
 };
 
 /******************************************************************************/
@@ -311,6 +316,16 @@ int init_keys(psb_context_t* ctx) {
         pos += key_len + 1;
     }
 
+    /* key table seems sorted by name (object keys point to it and are sorted by index as well),
+     * but test just in case since otherwise lookups would fail */
+    ctx->keys_sorted = 1;
+    for (i = 1; i < ctx->keys_count; i++) {
+        if (strcmp(&ctx->keys[ctx->keys_pos[i - 1]], &ctx->keys[ctx->keys_pos[i]]) >= 0) {
+            ctx->keys_sorted = 0;
+            break;
+        }
+    }
+
     return 1;
 fail:
     vgm_logi("PSBLIB: failed getting keys\n");
@@ -557,6 +572,82 @@ fail:
 }
 
 
+/* binary search in the sorted key table, returns key index or -1 */
+static int find_key_index(psb_context_t* ctx, const char* key) {
+    int lo = 0, hi = ctx->keys_count - 1;
+
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(&ctx->keys[ctx->keys_pos[mid]], key);
+        if (cmp == 0)
+            return mid;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+
+    return -1;
+}
+
+/* object key lists seem written sorted by key index, but test (once per object) just in case */
+static int is_object_sorted(psb_context_t* ctx, uint8_t* buf, list_t* keys, int max) {
+    int i;
+
+    if (ctx->sorted_object == buf)
+        return ctx->sorted_object_flag;
+
+    ctx->sorted_object = buf;
+    ctx->sorted_object_flag = 1;
+    for (i = 1; i < max; i++) {
+        if (list_get_entry(keys, i - 1) >= list_get_entry(keys, i)) {
+            ctx->sorted_object_flag = 0;
+            break;
+        }
+    }
+
+    return ctx->sorted_object_flag;
+}
+
+/* objects point to key indexes, so with a sorted table only need to find the key once and then
+ * compare ints (binary search if the object's list is sorted, linear search otherwise) */
+static int find_object_entry(const psb_node_t* node, int max, const char* key) {
+    uint8_t* buf = node->data;
+    list_t keys;
+    int i, lo, hi, key_index;
+
+    key_index = find_key_index(node->ctx, key);
+    if (key_index < 0)
+        return -1; /* not in file */
+
+    if (buf[0] != PSB_ITYPE_OBJECT)
+        return -1;
+    list_init(&keys, &buf[1]);
+
+    if (!is_object_sorted(node->ctx, buf, &keys, max)) {
+        for (i = 0; i < max; i++) {
+            if (list_get_entry(&keys, i) == key_index)
+                return i;
+        }
+        return -1;
+    }
+
+    lo = 0;
+    hi = max - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        int test_index = list_get_entry(&keys, mid);
+        if (test_index == key_index)
+            return mid;
+        if (test_index < key_index)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+
+    return -1;
+}
+
 int psb_node_by_key(const psb_node_t* node, const char* key, psb_node_t* p_out) {
     int i;
     int max;
@@ -568,12 +659,18 @@ int psb_node_by_key(const psb_node_t* node, const char* key, psb_node_t* p_out)
     if (max < 0 || max > node->ctx->keys_count)
         goto fail;
 
+    if (node->ctx->keys_sorted) {
+        i = find_object_entry(node, max, key);
+        if (i < 0)
+            goto fail;
+        return psb_node_by_index(node, i, p_out);
+    }
+
     for (i = 0; i < max; i++) {
         const char* key_test = psb_node_get_key(node, i);
         if (!key_test)
             goto fail;
 
-        //todo could improve by getting strlen(key) + ctx->key_len + check + strncmp
         if (strcmp(key_test, key) == 0)
             return psb_node_by_index(node, i, p_out);
     }
@@ -229,18 +229,10 @@ VGMSTREAM* allocate_vgmstream(int channels, int loop_flag) {
     vgmstream->channels = channels;
     vgmstream->loop_flag = loop_flag;
 
-    vgmstream->mixer = mixer_init(vgmstream->channels); /* pre-init */
-    if (!vgmstream->mixer) goto fail;
-
     vgmstream->decode_state = decode_init();
     if (!vgmstream->decode_state) goto fail;
 
-    //TODO: improve/init later to minimize memory
-    /* garbage buffer for seeking/discarding (local bufs may cause stack overflows with segments/layers)
-     * in theory the bigger the better but in practice there isn't much difference. */
-    vgmstream->tmpbuf_size = 1024 * 2 * channels * sizeof(float);
-    vgmstream->tmpbuf = malloc(vgmstream->tmpbuf_size);
-    if (!vgmstream->tmpbuf) goto fail;
+    /* tmpbuf (seeking/discarding) is allocated on first seek, as many vgmstreams are only opened for info */
 
     /* BEWARE: merge_vgmstream does some free'ing too */ 
 
@@ -275,6 +267,8 @@ void close_vgmstream(VGMSTREAM* vgmstream) {
             }
             vgmstream->ch[i].streamfile = NULL;
         }
+
+        free(vgmstream->ch[i].coef_table);
     }
 
     mixer_free(vgmstream->mixer);
@@ -24,7 +24,6 @@
 #include "streamfile.h"
 #include "vgmstream_types.h"
 
-#include "coding/g72x_state.h"
 
 
 typedef struct {
@@ -94,7 +93,9 @@ typedef struct {
 } play_state_t;
 
 
-/* info for a single vgmstream 'channel' (or rather, mono stream) */
+/* info for a single vgmstream 'channel' (or rather, mono stream)
+ * Copied around on resets and loops (see start_ch/loop_ch), so it should only have small per-sample state.
+ * Big codec-specific state is allocated separately (tables below or codec_data). */
 typedef struct {
     STREAMFILE* streamfile;     /* file used by this channel */
     off_t channel_start_offset; /* where data for this channel begins */
@@ -102,13 +103,6 @@ typedef struct {
 
     /* format and channel specific */
 
-    /* ADPCM with built or variable decode coefficients */
-    union {
-        int16_t adpcm_coef[16];         /* DSP, some ADX (in rare cases may change per block) */
-        int16_t vadpcm_coefs[8*2*8];    /* VADPCM: max 8 groups * max 2 order * fixed 8 subframe = 128 coefs */
-        int32_t adpcm_coef_3by32[96];   /* Level-5 0x555 */
-    };
-
     /* previous ADPCM samples */
     union {
         int16_t adpcm_history1_16;
@@ -136,13 +130,20 @@ typedef struct {
         int adpcm_scale;
     };
 
+    /* ADPCM with built or variable decode coefficients */
+    int16_t adpcm_coef[16];             /* DSP, some ADX (in rare cases may change per block) */
+
+    /* ADPCM with big coef tables, set on init then read-only (shared between ch copies, freed on close) */
+    union {
+        void* coef_table;
+        int16_t* vadpcm_coefs;          /* VADPCM: max 8 groups * max 2 order * fixed 8 subframe = 128 coefs */
+        int32_t* adpcm_coef_3by32;      /* Level-5 0x555: max 32 groups * 3 order = 96 coefs */
+    };
+
     /* Westwood Studios decoder */
     off_t ws_frame_header_offset;       /* offset of the current frame header */
     int ws_samples_left_in_frame;       /* last decoded info */
 
-    /* state for G.721 decoder, sort of big but we might as well keep it around */
-    struct g72x_state g72x_state;
-
     /* ADX encryption */
     uint16_t adx_xor;
     uint16_t adx_mult;
@@ -201,6 +202,7 @@ typedef struct {
     int32_t current_block_samples;  /* size in samples of the block we're in now (used over current_block_size if possible) */
     off_t next_block_offset;        /* offset of header of the next block */
     size_t full_block_size;         /* actual data size of an entire block (ie. may be fixed, include padding/headers, etc) */
+    void* block_index;              /* blocked layouts: offsets of blocks for seeking (optional, shared with start_vgmstream) */
 
     /* layout/block state copy for loops (saved on loop_start and restored later on loop_end) */
     int32_t loop_current_sample;    /* saved from current_sample (same as loop_start_sample, but more state-like) */
@@ -221,7 +223,8 @@ typedef struct {
     void* start_vgmstream;          /* shallow copy of the VGMSTREAM as it was at the beginning of the stream (for resets) */
     VGMSTREAMCHANNEL* start_ch;     /* shallow copy of channels as they were at the beginning of the stream (for resets) */
 
-    void* mixer;                    /* state for mixing effects */
+    void* mixer;                    /* state for mixing effects (created when first needed) */
+    bool mixing_ready;              /* mixing was set up, mixer can't be created or altered after this */
 
     /* Optional data the codec needs for the whole stream. This is for codecs too
      * different from vgmstream's structure to be reasonably shoehorned.
@@ -239,7 +242,7 @@ typedef struct {
     int loop_count;                 /* counter of complete loops (1=looped once) */
     int loop_target;                /* max loops before continuing with the stream end (loops forever if not set) */
 
-    void* tmpbuf;                   /* garbage buffer used for seeking/trimming */
+    void* tmpbuf;                   /* garbage buffer used for seeking/trimming (allocated on first seek) */
     size_t tmpbuf_size;             /* for all channels (samples = tmpbuf_size / channels / sample_size) */
 
     void* decode_state;             /* for some decoders (TO-DO: to be moved around) */